@@ -0,0 +1,56 @@
+#include "Bench.hh"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<quint64> gAllocations(0);
+
+#if defined(__GLIBC__)
+// Interpose the C allocator so allocations done by Qt (QArrayData, raster buffers) are counted too
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+void* operator new(std::size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+namespace Bench {
+
+quint64 allocationCount(void)
+{
+    return gAllocations.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+namespace Bench {
+
+// Number of heap allocations done by the process since startup (see Alloc.cc)
+quint64 allocationCount(void);
+
+struct Options {
+    qint64 minTimeNs = 20 * 1000 * 1000;
+    qint64 minIterations = 16;
+};
+
+class Runner {
+public:
+    explicit Runner(const Options &options);
+
+    // Run op until the minimal time is reached. op return the number of bytes produced by one call.
+    void run(const QString &name, const QJsonObject &params, const std::function<qint64(void)> &op);
+
+    // Add an already measured result (for benchmarks which need their own timing loop)
+    void add(const QString &name, const QJsonObject &params, const QJsonObject &result);
+
+    QJsonArray results(void) const;
+
+    // Record a failed check (a result differing from its reference implementation): RibbonBench then exits
+    // with a non-zero status
+    void fail(const QString &message);
+    QStringList failures(void) const;
+
+private:
+    Options mOptions;
+    QJsonArray mResults;
+    QStringList mFailures;
+};
+
+// Benchmark suites
+void styleBench(Runner &runner);
+void hitTestBench(Runner &runner);
+void layoutBench(Runner &runner);
+void policyBench(Runner &runner);
+void compareBench(Runner &runner);
+void definitionBench(Runner &runner);
+void commandBench(Runner &runner);
+void searchBench(Runner &runner);
+
+}
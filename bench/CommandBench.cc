@@ -0,0 +1,88 @@
+#include "Bench.hh"
+
+#include <CommandState.hh>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace RibbonUI;
+
+namespace Bench {
+
+// Worker threads changing random command states as fast as they can while the main thread drains at 60
+// frames per second. Reports the update rate, and how many changes reached the GUI side after coalescing.
+void commandBench(Runner &runner)
+{
+    const int commands = 10000;
+    const int threadCounts[] = {1, 2, 4, 8};
+    const int durationMs = 1000;
+
+    for (int threads : threadCounts) {
+        CommandStateStore store(commands);
+        std::atomic<bool> stop(false);
+        std::atomic<quint64> updates(0);
+        std::atomic<quint64> notifications(0);
+        store.setNotifier([&]() { notifications.fetch_add(1, std::memory_order_relaxed); });
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                quint32 x = quint32(t) * 2654435761u + 1;
+                quint64 count = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    // xorshift32
+                    x ^= x << 13;
+                    x ^= x >> 17;
+                    x ^= x << 5;
+                    CommandId command = CommandId(x % commands);
+                    switch ((x >> 16) % 3) {
+                    case 0: store.setEnabled(command, (x >> 20) & 1); break;
+                    case 1: store.setChecked(command, (x >> 21) & 1); break;
+                    default: store.setBadge(command, (x >> 22) & 7); break;
+                    }
+                    count++;
+                }
+                updates.fetch_add(count, std::memory_order_relaxed);
+            });
+        }
+
+        std::vector<CommandChange> changes;
+        qint64 drainNs = 0;
+        qint64 maxDrainNs = 0;
+        QElapsedTimer total;
+        total.start();
+        while (total.elapsed() < durationMs) {
+            QElapsedTimer timer;
+            timer.start();
+            changes.clear();
+            store.drain(&changes);
+            qint64 ns = timer.nsecsElapsed();
+            drainNs += ns;
+            maxDrainNs = std::max(maxDrainNs, ns);
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        }
+        stop.store(true);
+        for (std::thread &worker : workers)
+            worker.join();
+        double seconds = total.nsecsElapsed() / 1e9;
+
+        CommandStateStats stats = store.stats();
+        QJsonObject params;
+        params["threads"] = threads;
+        params["commands"] = commands;
+
+        QJsonObject result;
+        result["updates_per_second"] = double(updates.load()) / seconds;
+        result["drains"] = double(stats.drains);
+        result["notifications"] = double(notifications.load());
+        result["changes"] = double(stats.changes);
+        result["coalescing"] = stats.changes > 0 ? double(updates.load()) / stats.changes : 0.0;
+        result["drain_mean_ns"] = stats.drains > 0 ? double(drainNs) / stats.drains : 0.0;
+        result["drain_max_ns"] = double(maxDrainNs);
+        runner.add("commands.stress", params, result);
+    }
+}
+
+}
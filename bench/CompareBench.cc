@@ -0,0 +1,125 @@
+#include "Bench.hh"
+#include "ImageCompare.hh"
+
+#include <QPainter>
+
+namespace Bench {
+
+static quint32 nextRandom(quint32* state)
+{
+    // xorshift32
+    quint32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static QImage randomImage(const QSize &size, quint32* state)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < size.height(); y++) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < size.width(); x++) {
+            quint32 r = nextRandom(state);
+            int alpha = int(r & 0xff);
+            line[x] = qRgba(int((r >> 8) & 0xff) * alpha / 255, int((r >> 16) & 0xff) * alpha / 255,
+                            int(r >> 24) * alpha / 255, alpha);
+        }
+    }
+    return image;
+}
+
+static bool sameResult(const CompareResult &a, const CompareResult &b)
+{
+    return a.sizeMismatch == b.sizeMismatch && a.differing == b.differing && a.maxRed == b.maxRed
+        && a.maxGreen == b.maxGreen && a.maxBlue == b.maxBlue && a.maxAlpha == b.maxAlpha;
+}
+
+// The vector paths must find what the scalar one finds, including in the tail of rows which are not a
+// multiple of the vector width
+static void checkSimdLevels(Runner &runner, SimdLevel best)
+{
+    const int widths[] = {1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 67, 96};
+    const int tolerances[] = {0, 1, 8, 255};
+    quint32 state = 0x9e3779b9u;
+
+    for (int width : widths) {
+        QSize size(width, 7);
+        QImage reference = randomImage(size, &state);
+        // Some pixels changed slightly, some a lot: every channel delta from 0 to 255 shows up
+        QImage actual = reference.copy();
+        for (int i = 0; i < width * size.height() / 3 + 1; i++) {
+            quint32 r = nextRandom(&state);
+            QPoint pos(int(r % quint32(width)), int((r >> 8) % quint32(size.height())));
+            QRgb pixel = actual.pixel(pos);
+            int delta = (r >> 16) & 1 ? 1 + int((r >> 17) & 3) : int((r >> 17) & 0xff);
+            int alpha = qMin(255, qAlpha(pixel) + delta);
+            actual.setPixel(pos, qRgba(qMin(alpha, qRed(pixel) + delta), qGreen(pixel), qMax(0, qBlue(pixel) - delta), alpha));
+        }
+
+        for (int t : tolerances) {
+            Tolerance tolerance;
+            tolerance.red = tolerance.green = tolerance.blue = tolerance.alpha = t;
+            setSimdLevel(SimdScalar);
+            CompareResult expected = compareImages(actual, reference, tolerance);
+
+            for (int level = SimdScalar + 1; level <= best; level++) {
+                setSimdLevel(SimdLevel(level));
+                CompareResult result = compareImages(actual, reference, tolerance);
+                if (!sameResult(result, expected)) {
+                    runner.fail(QString("compare: %1 disagrees with scalar at width %2, tolerance %3 "
+                                        "(%4 differing pixels, scalar %5)")
+                                .arg(simdLevelName(SimdLevel(level))).arg(width).arg(t)
+                                .arg(result.differing).arg(expected.differing));
+                }
+            }
+        }
+    }
+    setSimdLevel(best);
+}
+
+// Comparator throughput by instruction set, on identical images and on images differing by a few pixels
+void compareBench(Runner &runner)
+{
+    const QList<QSize> sizes = {QSize(96, 66), QSize(1920, 1080)};
+    const SimdLevel best = detectSimdLevel();
+    checkSimdLevels(runner, best);
+
+    for (const QSize &size : sizes) {
+        QImage reference(size, QImage::Format_ARGB32_Premultiplied);
+        reference.fill(QColor(240, 240, 240));
+        {
+            QPainter p(&reference);
+            p.setRenderHint(QPainter::Antialiasing);
+            p.setBrush(QColor(200, 60, 40));
+            p.drawEllipse(QRect(QPoint(0, 0), size).adjusted(4, 4, -4, -4));
+        }
+        QImage differing = reference.copy();
+        differing.setPixel(size.width() / 2, size.height() / 2, qRgb(0, 0, 255));
+
+        // Bytes read by one comparison
+        const qint64 bytes = 2 * qint64(reference.bytesPerLine()) * reference.height();
+
+        for (int level = SimdScalar; level <= best; level++) {
+            setSimdLevel(SimdLevel(level));
+
+            QJsonObject params;
+            params["width"] = size.width();
+            params["height"] = size.height();
+            params["simd"] = simdLevelName(SimdLevel(level));
+
+            runner.run("compare.identical", params, [&]() {
+                compareImages(reference, reference, Tolerance());
+                return bytes;
+            });
+            runner.run("compare.differing", params, [&]() {
+                compareImages(differing, reference, Tolerance());
+                return bytes;
+            });
+        }
+        setSimdLevel(best);
+    }
+}
+
+}
@@ -0,0 +1,122 @@
+#include "Bench.hh"
+
+#include <RibbonDefinition.hh>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSaveFile>
+
+using namespace RibbonUI;
+
+namespace Bench {
+
+// 1,000 commands: 10 tabs of 10 groups of 10 commands
+static QJsonDocument makeSource(void)
+{
+    const char* sizes[] = {"large", "large", "medium", "medium", "medium", "medium", "small", "small", "small", "small"};
+    QJsonArray tabs;
+    for (int t = 0; t < 10; t++) {
+        QJsonArray groups;
+        for (int g = 0; g < 10; g++) {
+            QJsonArray commands;
+            for (int c = 0; c < 10; c++) {
+                QJsonObject command;
+                command["id"] = QString("command.%1.%2.%3").arg(t).arg(g).arg(c);
+                command["label"] = QString("Command %1").arg((t * 100 + g * 10 + c) % 250);
+                command["icon"] = QString("icon%1").arg(c);
+                command["size"] = sizes[c];
+                commands.append(command);
+            }
+            QJsonObject group;
+            group["title"] = QString("Group %1").arg(g);
+            group["commands"] = commands;
+            groups.append(group);
+        }
+        QJsonObject tab;
+        tab["title"] = QString("Tab %1").arg(t);
+        tab["groups"] = groups;
+        tabs.append(tab);
+    }
+    QJsonObject root;
+    root["tabs"] = tabs;
+    return QJsonDocument(root);
+}
+
+static void buildAll(const RibbonDefinition &definition)
+{
+    for (int t = 0; t < definition.tabCount(); t++) {
+        Tab tab;
+        definition.build(t, tab);
+    }
+}
+
+// Build the same tabs from the JSON source, as code would
+static void buildFromJson(const QJsonDocument &source)
+{
+    for (const QJsonValue &tabValue : source.object().value("tabs").toArray()) {
+        Tab tab(tabValue.toObject().value("title").toString());
+        for (const QJsonValue &groupValue : tabValue.toObject().value("groups").toArray()) {
+            GroupId group = tab.addGroup(groupValue.toObject().value("title").toString());
+            for (const QJsonValue &commandValue : groupValue.toObject().value("commands").toArray()) {
+                QString size = commandValue.toObject().value("size").toString();
+                tab.addControl(group, commandValue.toObject().value("label").toString(), QPixmap(),
+                               size == "large" ? LargeControl : size == "medium" ? MediumControl : SmallControl);
+            }
+        }
+    }
+}
+
+void definitionBench(Runner &runner)
+{
+    const QJsonDocument source = makeSource();
+    const QByteArray json = source.toJson(QJsonDocument::Compact);
+    const QByteArray compiled = RibbonDefinition::compile(source);
+    const QString path = QDir::temp().filePath(QString("RibbonBench-%1.ribbon").arg(QCoreApplication::applicationPid()));
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(compiled) != compiled.size() || !file.commit())
+        return;
+
+    QJsonObject params;
+    params["commands"] = 1000;
+    params["binary_bytes"] = compiled.size();
+    params["json_bytes"] = json.size();
+
+    // Cold: first mapping of the file in this process (the system cache may still hold it)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        RibbonDefinition definition;
+        definition.open(path);
+        qint64 openNs = timer.nsecsElapsed();
+        buildAll(definition);
+
+        QJsonObject result;
+        result["open_ns"] = double(openNs);
+        result["open_build_ns"] = double(timer.nsecsElapsed());
+        runner.add("definition.cold", params, result);
+    }
+
+    runner.run("definition.warm.open", params, [&]() {
+        RibbonDefinition definition;
+        definition.open(path);
+        return qint64(compiled.size());
+    });
+    runner.run("definition.warm.build", params, [&]() {
+        RibbonDefinition definition;
+        definition.open(path);
+        buildAll(definition);
+        return qint64(0);
+    });
+    runner.run("definition.json.build", params, [&]() {
+        buildFromJson(QJsonDocument::fromJson(json));
+        return qint64(json.size());
+    });
+
+    QFile::remove(path);
+}
+
+}
@@ -0,0 +1,174 @@
+// RibbonGolden: renders FlatStyle output offscreen and compares it to reference images.
+//
+// Usage: RibbonGolden --references dir [--update] [--diff dir] [--tolerance n | r,g,b,a]
+// With --update the references are (re)written instead of compared. Text rendering depends on the fonts of
+// the machine, references are meant to be generated on the platform which checks them.
+// The exit status is 1 if an image differs from (or is missing in) the references.
+
+#include "ImageCompare.hh"
+
+#include <RibbonStyle/Flat.hh>
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QPainter>
+
+#include <cstdio>
+
+using namespace RibbonUI::RibbonStyle;
+
+static const char* stateName(ButtonState state)
+{
+    switch (state) {
+    case NORMAL: return "normal";
+    case HOVER: return "hover";
+    case ACTIVE: return "active";
+    case DISABLED: return "disabled";
+    }
+    return "unknown";
+}
+
+// Same icon on every machine
+static QImage makeIcon(qreal dpr)
+{
+    QImage icon(QSize(32, 32) * dpr, QImage::Format_ARGB32_Premultiplied);
+    icon.setDevicePixelRatio(dpr);
+    icon.fill(Qt::transparent);
+
+    QPainter p(&icon);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setBrush(QColor(200, 60, 40));
+    p.setPen(Qt::NoPen);
+    p.drawEllipse(QRect(2, 2, 28, 28));
+    return icon;
+}
+
+static bool parseTolerance(const QString &arg, Bench::Tolerance* tolerance)
+{
+    QStringList parts = arg.split(',');
+    bool ok = true;
+    if (parts.size() == 1) {
+        int value = parts[0].toInt(&ok);
+        tolerance->red = tolerance->green = tolerance->blue = tolerance->alpha = value;
+        return ok;
+    }
+    if (parts.size() != 4)
+        return false;
+    int* channels[] = {&tolerance->red, &tolerance->green, &tolerance->blue, &tolerance->alpha};
+    for (int i = 0; i < 4 && ok; i++)
+        *channels[i] = parts[i].toInt(&ok);
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+#ifdef Q_OS_LINUX
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+    QApplication app(argc, argv);
+
+    QString references;
+    QString diffs;
+    bool update = false;
+    Bench::Tolerance tolerance;
+
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); i++) {
+        if (args[i] == "--references" && i + 1 < args.size())
+            references = args[++i];
+        else if (args[i] == "--diff" && i + 1 < args.size())
+            diffs = args[++i];
+        else if (args[i] == "--update")
+            update = true;
+        else if (args[i] == "--tolerance" && i + 1 < args.size() && parseTolerance(args[++i], &tolerance))
+            continue;
+        else {
+            references.clear();
+            break;
+        }
+    }
+    if (references.isEmpty()) {
+        fprintf(stderr, "usage: %s --references dir [--update] [--diff dir] [--tolerance n | r,g,b,a]\n", argv[0]);
+        return 2;
+    }
+    QDir().mkpath(references);
+    if (!diffs.isEmpty())
+        QDir().mkpath(diffs);
+
+    const QList<QSize> sizes = {QSize(0, 0), QSize(24, 24), QSize(96, 66), QSize(160, 90)};
+    const QList<ButtonState> states = {NORMAL, HOVER, ACTIVE, DISABLED};
+    const QStringList labels = {QString(), "Paste", "Insert Table of Contents Entry"};
+    const QList<qreal> ratios = {1.0, 1.25, 1.5, 2.0};
+
+    FlatStyle style;
+    int compared = 0;
+    int failed = 0;
+    qint64 compareNs = 0;
+    QElapsedTimer timer;
+
+    for (qreal dpr : ratios) {
+        const QImage icons[2] = {QImage(), makeIcon(dpr)};
+        for (const QSize &size : sizes) {
+            for (ButtonState state : states) {
+                for (int l = 0; l < labels.size(); l++) {
+                    for (int i = 0; i < 2; i++) {
+                        for (int kind = 0; kind < 2; kind++) {
+                            QImage image = kind == 0
+                                ? style.drawTabImage(size, state, labels[l], icons[i], QSize(), dpr)
+                                : style.drawButtonImage(size, state, labels[l], icons[i], QSize(), dpr);
+
+                            QString name = QString("%1_%2_%3x%4_dpr%5_label%6%7.png")
+                                .arg(kind == 0 ? "tab" : "button").arg(stateName(state))
+                                .arg(size.width()).arg(size.height()).arg(dpr * 100).arg(l)
+                                .arg(i == 0 ? "" : "_icon");
+                            QString path = QDir(references).filePath(name);
+
+                            if (update) {
+                                if (!image.save(path))
+                                    fprintf(stderr, "cannot write %s\n", qPrintable(path));
+                                continue;
+                            }
+
+                            QImage reference(path);
+                            if (reference.isNull()) {
+                                fprintf(stderr, "missing: %s\n", qPrintable(name));
+                                failed++;
+                                continue;
+                            }
+
+                            QImage heatmap;
+                            timer.start();
+                            Bench::CompareResult result = Bench::compareImages(image, reference, tolerance, diffs.isEmpty() ? nullptr : &heatmap);
+                            compareNs += timer.nsecsElapsed();
+                            compared++;
+
+                            if (result.passed())
+                                continue;
+                            failed++;
+                            if (result.sizeMismatch) {
+                                fprintf(stderr, "size mismatch: %s (%dx%d, reference %dx%d)\n", qPrintable(name),
+                                        image.width(), image.height(), reference.width(), reference.height());
+                                continue;
+                            }
+                            fprintf(stderr, "differs: %s (%lld pixels, max delta r%d g%d b%d a%d)\n", qPrintable(name),
+                                    result.differing, result.maxRed, result.maxGreen, result.maxBlue, result.maxAlpha);
+                            if (!heatmap.isNull())
+                                heatmap.save(QDir(diffs).filePath(name));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (update) {
+        printf("references written to %s\n", qPrintable(references));
+        return 0;
+    }
+
+    printf("%d images compared (%s), %d failed, %.3f ms comparing\n", compared,
+           Bench::simdLevelName(Bench::simdLevel()), failed, compareNs / 1e6);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#include "Bench.hh"
+
+#include <CustomWindow.hh>
+
+#include <QApplication>
+#include <QStyleOption>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using CustomWindow::HitZone;
+
+namespace Bench {
+
+// Straightforward hit test, as CustomWindow did it before any caching: used to cross-check the real one
+static HitZone referenceHitTest(CustomWindow::CustomWindow &window, const std::vector<QWidget*> &captions, const QPoint &pos)
+{
+    QRect frame = window.frameGeometry();
+
+    QStyleOptionTitleBar title;
+    title.initFrom(&window);
+    title.titleBarFlags = window.windowFlags();
+    title.rect.setRect(0, 0, window.width(), window.style()->pixelMetric(QStyle::PM_TitleBarHeight));
+
+    bool controls = false;
+    for (QStyle::SubControl sc : {QStyle::SC_TitleBarCloseButton, QStyle::SC_TitleBarMaxButton,
+                                  QStyle::SC_TitleBarMinButton, QStyle::SC_TitleBarNormalButton})
+        controls = controls || window.style()->subControlRect(QStyle::CC_TitleBar, &title, sc, nullptr).contains(pos);
+
+    if (!controls) {
+        QWidget* w = QApplication::widgetAt(pos + frame.topLeft());
+        controls = w != nullptr && w != &window;
+    }
+
+    if (controls) {
+        for (const QWidget* widget : captions) {
+            QPoint wpos = widget->mapToGlobal(QPoint(0, 0)) - window.pos();
+            if (wpos.x() <= pos.x() && pos.x() <= wpos.x() + widget->width()
+                && wpos.y() <= pos.y() && pos.y() <= wpos.y() + widget->height())
+                return CustomWindow::HitCaption;
+        }
+        return CustomWindow::HitClient;
+    }
+
+    int border = window.borderSize();
+    int titleBar = window.titleBarSize();
+    bool top = pos.y() >= 0 && pos.y() <= border;
+    bool caption = !top && pos.y() >= border && pos.y() <= border + titleBar;
+    bool bottom = !top && !caption && pos.y() >= frame.height() - border && pos.y() < frame.height();
+    bool left = pos.x() >= 0 && pos.x() < border;
+    bool right = !left && pos.x() >= frame.width() - border && pos.x() < frame.width();
+
+    if (left)
+        return top ? CustomWindow::HitTopLeft : bottom ? CustomWindow::HitBottomLeft : CustomWindow::HitLeft;
+    if (right)
+        return top ? CustomWindow::HitTopRight : bottom ? CustomWindow::HitBottomRight : CustomWindow::HitRight;
+    if (top)
+        return CustomWindow::HitTop;
+    if (bottom)
+        return CustomWindow::HitBottom;
+    return caption ? CustomWindow::HitCaption : CustomWindow::HitNowhere;
+}
+
+static double percentile(const std::vector<qint64> &sorted, double p)
+{
+    return double(sorted[std::min(sorted.size() - 1, size_t(p * sorted.size()))]);
+}
+
+void hitTestBench(Runner &runner)
+{
+    const int captionCounts[] = {0, 8, 32, 128};
+    const int borderSizes[] = {1, 4, 8};
+    const qreal scales[] = {1.0, 1.5, 2.0};
+    const int samples = 20000;
+
+    std::mt19937 rng(42);
+
+    for (qreal scale : scales) {
+        for (int border : borderSizes) {
+            for (int count : captionCounts) {
+                CustomWindow::CustomWindow window;
+                QSize size = QSize(1280, 800) * scale;
+                window.resize(size.width(), size.height(), CustomWindow::borderSizing);
+                window.setBorderSize(qRound(border * scale));
+                window.setTitleBarSize(qRound(30 * scale));
+                window.setFrameRemoved(true);
+
+                // Caption strips in the title bar and the tab strip, with client controls between them
+                std::vector<QWidget*> captions;
+                int stripTop = window.borderSize();
+                int stripHeight = window.titleBarSize() + qRound(30 * scale);
+                for (int i = 0; i < count; i++) {
+                    QWidget* w = new QWidget(&window);
+                    int x = int(rng() % size.width());
+                    w->setGeometry(x, stripTop + int(rng() % stripHeight), int(rng() % 120) + 8, int(rng() % 24) + 4);
+                    window.declareCaption(w);
+                    captions.push_back(w);
+                }
+                for (int i = 0; i < 16; i++) {
+                    QWidget* w = new QWidget(&window);
+                    w->setGeometry(int(rng() % size.width()), int(rng() % size.height()), 80, 24);
+                }
+
+                window.show();
+                QApplication::processEvents();
+
+                // Uniform cursor positions, plus a sweep of the title bar where the captions are
+                std::vector<QPoint> stream;
+                auto makeStream = [&]() {
+                    QSize current = window.frameGeometry().size();
+                    stream.clear();
+                    stream.reserve(samples);
+                    for (int i = 0; i < samples / 2; i++)
+                        stream.emplace_back(int(rng() % current.width()), int(rng() % current.height()));
+                    for (int i = 0; i < samples / 2; i++)
+                        stream.emplace_back(i % current.width(), stripTop + (i / current.width()) % stripHeight);
+                };
+
+                int mismatches = 0;
+                auto crossCheck = [&](const char* step) {
+                    QApplication::processEvents();
+                    int found = 0;
+                    QPoint first;
+                    for (const QPoint &pos : stream) {
+                        if (window.hitTest(pos) != referenceHitTest(window, captions, pos)) {
+                            if (found++ == 0)
+                                first = pos;
+                        }
+                    }
+                    if (found > 0) {
+                        runner.fail(QString("hittest: %1 mismatches with the reference after %2, first at (%3, %4), %5 captions, scale %6")
+                                    .arg(found).arg(step).arg(first.x()).arg(first.y()).arg(count).arg(scale));
+                    }
+                    mismatches += found;
+                };
+                makeStream();
+                crossCheck("show");
+
+                std::vector<qint64> latencies;
+                latencies.reserve(stream.size());
+                for (const QPoint &pos : stream) {
+                    auto start = std::chrono::steady_clock::now();
+                    volatile HitZone zone = window.hitTest(pos);
+                    Q_UNUSED(zone);
+                    latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+                }
+                std::sort(latencies.begin(), latencies.end());
+
+                QJsonObject params;
+                params["captions"] = count;
+                params["border"] = window.borderSize();
+                params["scale"] = scale;
+
+                QJsonObject result;
+                result["calls"] = int(latencies.size());
+                result["p50_ns"] = percentile(latencies, 0.50);
+                result["p90_ns"] = percentile(latencies, 0.90);
+                result["p99_ns"] = percentile(latencies, 0.99);
+                result["max_ns"] = double(latencies.back());
+
+                // The caches must follow geometry changes: of the captions, of their ancestors and of the frame
+                for (size_t i = 0; i < captions.size(); i += 3)
+                    captions[i]->move(captions[i]->pos() + QPoint(int(rng() % 41) - 20, int(rng() % 21) - 10));
+                crossCheck("moving captions");
+                for (size_t i = 1; i < captions.size(); i += 3)
+                    captions[i]->resize(int(rng() % 120) + 8, int(rng() % 24) + 4);
+                crossCheck("resizing captions");
+
+                QWidget* container = new QWidget(&window);
+                container->setGeometry(0, 0, size.width(), stripTop + stripHeight);
+                container->show();
+                for (size_t i = 0; i < captions.size(); i += 2) {
+                    captions[i]->setParent(container);
+                    captions[i]->show();
+                }
+                crossCheck("reparenting captions");
+                container->move(qRound(16 * scale), qRound(8 * scale));
+                crossCheck("moving a caption ancestor");
+
+                for (size_t i = 2; i < captions.size(); i += 4)
+                    captions[i]->hide();
+                crossCheck("hiding captions");
+
+                window.resize(size.width() * 3 / 4, size.height() * 3 / 4, CustomWindow::borderSizing);
+                makeStream();
+                crossCheck("resizing the window");
+                window.setBorderSize(qRound((border + 3) * scale));
+                crossCheck("changing the border size");
+                window.setTitleBarSize(qRound(40 * scale));
+                crossCheck("changing the title bar size");
+
+                result["mismatches"] = mismatches;
+                runner.add("customwindow.hitTest", params, result);
+            }
+        }
+    }
+}
+
+}
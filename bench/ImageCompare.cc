@@ -0,0 +1,232 @@
+#include "ImageCompare.hh"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define RIBBON_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define RIBBON_TARGET_AVX2
+    #else
+        #define RIBBON_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace Bench {
+
+// Channel maxima in memory order of a premultiplied ARGB32 pixel (little endian: B, G, R, A)
+struct RowState {
+    quint8 max[4] = {0, 0, 0, 0};
+};
+
+static SimdLevel gLevel = detectSimdLevel();
+
+static inline int popcount(unsigned int x)
+{
+#ifdef _MSC_VER
+    return int(__popcnt(x));
+#else
+    return __builtin_popcount(x);
+#endif
+}
+
+// Number of pixels with a channel outside tolerance, from a mask with one bit per byte set when the byte
+// is within tolerance
+static inline int failingPixels(unsigned int within, unsigned int bytes)
+{
+    unsigned int outside = ~within & ((bytes == 32) ? 0xffffffffu : ((1u << bytes) - 1));
+    outside |= outside >> 1;
+    outside |= outside >> 2;
+    return popcount(outside & 0x11111111u);
+}
+
+static qint64 compareRowScalar(const quint8* a, const quint8* b, int pixels, const quint8 tolerance[4], RowState &state)
+{
+    qint64 differing = 0;
+    for (int i = 0; i < pixels; i++) {
+        bool outside = false;
+        for (int c = 0; c < 4; c++) {
+            int delta = std::abs(int(a[4 * i + c]) - int(b[4 * i + c]));
+            state.max[c] = quint8(std::max(int(state.max[c]), delta));
+            outside = outside || delta > tolerance[c];
+        }
+        if (outside)
+            differing++;
+    }
+    return differing;
+}
+
+#ifdef RIBBON_X86
+static qint64 compareRowSSE2(const quint8* a, const quint8* b, int pixels, const quint8 tolerance[4], RowState &state)
+{
+    const __m128i tol = _mm_set1_epi32(int(quint32(tolerance[0]) | quint32(tolerance[1]) << 8
+                                           | quint32(tolerance[2]) << 16 | quint32(tolerance[3]) << 24));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i max = zero;
+
+    qint64 differing = 0;
+    int i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 4 * i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 4 * i));
+        __m128i delta = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        max = _mm_max_epu8(max, delta);
+        unsigned int within = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(delta, tol), zero)));
+        if (within != 0xffff)
+            differing += failingPixels(within, 16);
+    }
+
+    alignas(16) quint8 lanes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), max);
+    for (int l = 0; l < 16; l++)
+        state.max[l % 4] = std::max(state.max[l % 4], lanes[l]);
+
+    return differing + compareRowScalar(a + 4 * i, b + 4 * i, pixels - i, tolerance, state);
+}
+
+RIBBON_TARGET_AVX2
+static qint64 compareRowAVX2(const quint8* a, const quint8* b, int pixels, const quint8 tolerance[4], RowState &state)
+{
+    const __m256i tol = _mm256_set1_epi32(int(quint32(tolerance[0]) | quint32(tolerance[1]) << 8
+                                              | quint32(tolerance[2]) << 16 | quint32(tolerance[3]) << 24));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i max = zero;
+
+    qint64 differing = 0;
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 4 * i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 4 * i));
+        __m256i delta = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        max = _mm256_max_epu8(max, delta);
+        unsigned int within = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_subs_epu8(delta, tol), zero)));
+        if (within != 0xffffffffu)
+            differing += failingPixels(within, 32);
+    }
+
+    alignas(32) quint8 lanes[32];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), max);
+    for (int l = 0; l < 32; l++)
+        state.max[l % 4] = std::max(state.max[l % 4], lanes[l]);
+
+    return differing + compareRowScalar(a + 4 * i, b + 4 * i, pixels - i, tolerance, state);
+}
+#endif
+
+SimdLevel detectSimdLevel(void)
+{
+#if defined(RIBBON_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5))
+            return SimdAVX2;
+    }
+    return SimdSSE2;
+#elif defined(RIBBON_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SimdAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdSSE2;
+    return SimdScalar;
+#else
+    return SimdScalar;
+#endif
+}
+
+SimdLevel simdLevel(void)
+{
+    return gLevel;
+}
+
+void setSimdLevel(SimdLevel level)
+{
+    gLevel = std::min(level, detectSimdLevel());
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SimdSSE2: return "sse2";
+    case SimdAVX2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+static void heatmapRow(const quint8* a, const quint8* b, int pixels, const quint8 tolerance[4], QRgb* out)
+{
+    for (int i = 0; i < pixels; i++) {
+        int delta = 0;
+        bool outside = false;
+        for (int c = 0; c < 4; c++) {
+            int d = std::abs(int(a[4 * i + c]) - int(b[4 * i + c]));
+            delta = std::max(delta, d);
+            outside = outside || d > tolerance[c];
+        }
+
+        if (outside) {
+            out[i] = qRgb(128 + delta / 2, 0, 0);
+        }
+        else {
+            const QRgb reference = reinterpret_cast<const QRgb*>(b)[i];
+            int grey = qGray(reference) / 4;
+            out[i] = qRgb(grey, grey, grey);
+        }
+    }
+}
+
+CompareResult compareImages(const QImage &actual, const QImage &reference, const Tolerance &tolerance, QImage* heatmap)
+{
+    CompareResult result;
+    if (actual.size() != reference.size()) {
+        result.sizeMismatch = true;
+        return result;
+    }
+
+    const QImage::Format format = QImage::Format_ARGB32_Premultiplied;
+    QImage a = actual.format() == format ? actual : actual.convertToFormat(format);
+    QImage b = reference.format() == format ? reference : reference.convertToFormat(format);
+
+    const quint8 tol[4] = {
+        quint8(qBound(0, tolerance.blue, 255)), quint8(qBound(0, tolerance.green, 255)),
+        quint8(qBound(0, tolerance.red, 255)), quint8(qBound(0, tolerance.alpha, 255))
+    };
+
+    auto compareRow = &compareRowScalar;
+#ifdef RIBBON_X86
+    if (gLevel == SimdAVX2)
+        compareRow = &compareRowAVX2;
+    else if (gLevel == SimdSSE2)
+        compareRow = &compareRowSSE2;
+#endif
+
+    RowState state;
+    bool drawing = false;
+    for (int y = 0; y < a.height(); y++) {
+        const quint8* rowA = a.constScanLine(y);
+        const quint8* rowB = b.constScanLine(y);
+        result.differing += compareRow(rowA, rowB, a.width(), tol, state);
+
+        // The heatmap is only built from the first difference, with the rows before it
+        if (heatmap != nullptr && !drawing && result.differing > 0) {
+            drawing = true;
+            *heatmap = QImage(a.size(), QImage::Format_RGB32);
+            for (int r = 0; r < y; r++)
+                heatmapRow(a.constScanLine(r), b.constScanLine(r), a.width(), tol, reinterpret_cast<QRgb*>(heatmap->scanLine(r)));
+        }
+        if (drawing)
+            heatmapRow(rowA, rowB, a.width(), tol, reinterpret_cast<QRgb*>(heatmap->scanLine(y)));
+    }
+
+    result.maxBlue = state.max[0];
+    result.maxGreen = state.max[1];
+    result.maxRed = state.max[2];
+    result.maxAlpha = state.max[3];
+    return result;
+}
+
+}
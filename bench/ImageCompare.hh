@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QImage>
+
+namespace Bench {
+
+enum SimdLevel {
+    SimdScalar,
+    SimdSSE2,
+    SimdAVX2
+};
+
+// Best level supported by the CPU, and level used by compareImages (lowered for benchmarks)
+SimdLevel detectSimdLevel(void);
+SimdLevel simdLevel(void);
+void setSimdLevel(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
+
+// Accepted absolute difference by channel of premultiplied ARGB32 pixels
+struct Tolerance {
+    int red = 0;
+    int green = 0;
+    int blue = 0;
+    int alpha = 0;
+};
+
+struct CompareResult {
+    bool sizeMismatch = false;
+    // Pixels with a channel outside tolerance
+    qint64 differing = 0;
+    int maxRed = 0;
+    int maxGreen = 0;
+    int maxBlue = 0;
+    int maxAlpha = 0;
+
+    bool passed(void) const { return !sizeMismatch && differing == 0; }
+};
+
+// Compare two images (converted to premultiplied ARGB32 if needed, device pixel ratio ignored). If heatmap is
+// given and the images differ, it receives the reference in dim grey with differing pixels in red, brighter
+// for larger differences.
+CompareResult compareImages(const QImage &actual, const QImage &reference, const Tolerance &tolerance, QImage* heatmap = nullptr);
+
+}
@@ -0,0 +1,130 @@
+#include "Bench.hh"
+
+#include <RibbonStyle/Cache.hh>
+#include <RibbonStyle/Flat.hh>
+#include <RibbonTab.hh>
+#include <RibbonWindow.hh>
+
+#include <QPainter>
+
+#include <algorithm>
+#include <vector>
+
+using namespace RibbonUI;
+
+namespace Bench {
+
+static QPixmap makeIcon(int size, const QColor &color)
+{
+    QPixmap icon(size, size);
+    icon.fill(Qt::transparent);
+
+    QPainter p(&icon);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setBrush(color);
+    p.setPen(Qt::NoPen);
+    p.drawEllipse(QRect(1, 1, size - 2, size - 2));
+    return icon;
+}
+
+// Groups mixing a few large controls and stacks of medium ones, as in a typical "Home" tab
+static void fillTab(Tab &tab, int groups)
+{
+    const QStringList labels = {"Paste", "Cut", "Copy", "Format Painter", "Bold", "Italic", "Find", "Replace"};
+
+    for (int g = 0; g < groups; g++) {
+        GroupId group = tab.addGroup(QString("Group %1").arg(g));
+        QPixmap icon = makeIcon(32, QColor::fromHsv((g * 37) % 360, 160, 200));
+        for (int c = 0; c < 8; c++)
+            tab.addControl(group, labels[c], icon, c < 2 ? LargeControl : MediumControl);
+    }
+}
+
+// Window startup with every tab page built against the lazy pages, only the first one being activated
+static void windowBench(Runner &runner)
+{
+    const int tabCounts[] = {4, 12, 32};
+
+    for (int tabs : tabCounts) {
+        QJsonObject params;
+        params["tabs"] = tabs;
+        params["groups"] = 8;
+
+        for (bool lazy : {false, true}) {
+            runner.run(lazy ? "window.startup.lazy" : "window.startup.eager", params, [&]() {
+                RibbonStyle::StyleRegistry::shared().cache().clear();
+                Window window(nullptr, Qt::Window);
+                window.resize(1280, 200);
+                for (int t = 0; t < tabs; t++)
+                    window.addTab(QString("Tab %1").arg(t), [](Tab &tab) { fillTab(tab, 8); });
+                if (!lazy) {
+                    for (int t = tabs - 1; t >= 0; t--)
+                        window.setCurrentTab(t);
+                }
+                window.setCurrentTab(0);
+                return qint64(0);
+            });
+        }
+    }
+}
+
+void layoutBench(Runner &runner)
+{
+    const int groupCounts[] = {4, 16, 64};
+    const int stepSizes[] = {1, 8};
+
+    RibbonStyle::FlatStyle flat;
+    RibbonStyle::CachedStyle style(&flat);
+
+    for (int groups : groupCounts) {
+        QJsonObject params;
+        params["groups"] = groups;
+        params["controls"] = groups * 8;
+
+        Tab tab;
+        fillTab(tab, groups);
+
+        runner.run("tab.layout.full", params, [&]() {
+            tab.invalidate();
+            tab.layout(style);
+            return qint64(0);
+        });
+
+        // One label change: only its group is measured again
+        int counter = 0;
+        runner.run("tab.layout.relabel", params, [&]() {
+            tab.setLabel(ControlId(counter % tab.controlCount()), QString("Label %1").arg(counter % 5));
+            counter++;
+            tab.layout(style);
+            return qint64(0);
+        });
+
+        tab.layout(style);
+        const std::vector<int> &breakpoints = tab.breakpoints();
+        int widest = breakpoints.front() + 64;
+        int narrowest = std::max(0, breakpoints.back() - 64);
+
+        for (int stepSize : stepSizes) {
+            // Live drag from the widest to the narrowest width and back, one width per operation
+            std::vector<int> widths;
+            for (int w = widest; w >= narrowest; w -= stepSize)
+                widths.push_back(w);
+            for (int w = narrowest; w <= widest; w += stepSize)
+                widths.push_back(w);
+
+            QJsonObject sweep = params;
+            sweep["step_px"] = stepSize;
+            sweep["breakpoints"] = int(breakpoints.size());
+
+            size_t index = 0;
+            runner.run("tab.resize", sweep, [&]() {
+                tab.setAvailableWidth(widths[index++ % widths.size()]);
+                return qint64(0);
+            });
+        }
+    }
+
+    windowBench(runner);
+}
+
+}
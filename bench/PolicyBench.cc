@@ -0,0 +1,55 @@
+#include "Bench.hh"
+
+#include <RibbonStyle/Cache.hh>
+#include <RibbonStyle/Flat.hh>
+#include <RibbonStyle/Policy.hh>
+
+#include <memory>
+
+using namespace RibbonUI::RibbonStyle;
+
+namespace Bench {
+
+// Same drawing through PolicyRenderer (static), PolicyStyle and FlatStyle (both behind RibbonStyle*)
+void policyBench(Runner &runner)
+{
+    const QList<QSize> sizes = {QSize(24, 24), QSize(96, 66)};
+    const QList<ButtonState> states = {NORMAL, HOVER};
+    const QStringList labels = {"Paste", "Insert Table of Contents Entry"};
+
+    std::unique_ptr<RibbonStyle> policy(new PolicyStyle<FlatPolicy>());
+    std::unique_ptr<RibbonStyle> flat(new FlatStyle());
+    const qreal dpr = 1.0;
+
+    for (const QSize &size : sizes) {
+        for (ButtonState state : states) {
+            for (const QString &label : labels) {
+                QJsonObject params;
+                params["width"] = size.width();
+                params["height"] = size.height();
+                params["hover"] = state == HOVER;
+                params["label_length"] = label.size();
+
+                runner.run("static.drawButton", params, [&]() {
+                    return PixmapCache::pixmapBytes(PolicyRenderer<FlatPolicy>::drawButton(size, state, label, QPixmap(), QSize(), dpr));
+                });
+                runner.run("virtual.policy.drawButton", params, [&]() {
+                    return PixmapCache::pixmapBytes(policy->drawButton(size, state, label));
+                });
+                runner.run("virtual.flat.drawButton", params, [&]() {
+                    return PixmapCache::pixmapBytes(flat->drawButton(size, state, label));
+                });
+
+                // Paint only, in a reused surface: where folding the policy tables matters most
+                QImage target(size, QImage::Format_ARGB32_Premultiplied);
+                runner.run("static.paintButton", params, [&]() {
+                    QPainter p(&target);
+                    PolicyRenderer<FlatPolicy>::paintButton(p, QRect(QPoint(0, 0), size), state, label, QPixmap(), dpr);
+                    return qint64(0);
+                });
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,62 @@
+#include "Bench.hh"
+
+#include <cstdio>
+
+namespace Bench {
+
+Runner::Runner(const Options &options) : mOptions(options)
+{
+}
+
+void Runner::run(const QString &name, const QJsonObject &params, const std::function<qint64(void)> &op)
+{
+    // Warm up (first call may load fonts or fill caches)
+    op();
+
+    qint64 iterations = 0;
+    qint64 bytes = 0;
+    quint64 allocations = allocationCount();
+    QElapsedTimer timer;
+    timer.start();
+
+    while (iterations < mOptions.minIterations || timer.nsecsElapsed() < mOptions.minTimeNs) {
+        bytes += op();
+        iterations++;
+    }
+
+    qint64 elapsed = timer.nsecsElapsed();
+    allocations = allocationCount() - allocations;
+
+    QJsonObject result;
+    result["iterations"] = iterations;
+    result["ns_per_op"] = double(elapsed) / iterations;
+    result["allocs_per_op"] = double(allocations) / iterations;
+    result["pixmap_bytes_per_op"] = double(bytes) / iterations;
+    add(name, params, result);
+}
+
+void Runner::add(const QString &name, const QJsonObject &params, const QJsonObject &result)
+{
+    QJsonObject entry = result;
+    entry["name"] = name;
+    entry["params"] = params;
+    mResults.append(entry);
+}
+
+QJsonArray Runner::results(void) const
+{
+    return mResults;
+}
+
+void Runner::fail(const QString &message)
+{
+    fprintf(stderr, "FAILED: %s\n", qPrintable(message));
+    mFailures.append(message);
+}
+
+QStringList Runner::failures(void) const
+{
+    return mFailures;
+}
+
+}
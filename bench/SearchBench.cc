@@ -0,0 +1,93 @@
+#include "Bench.hh"
+
+#include <CommandIndex.hh>
+
+#include <vector>
+
+using namespace RibbonUI;
+
+namespace Bench {
+
+// 10,000 labels like "Insert Table Row" with a synonym each, some with accents
+static void makeCommands(QStringList* labels, QStringList* keywords)
+{
+    const QStringList verbs = {"Insert", "Delete", "Format", "Copy", "Paste", "Align", "Sort", "Filter", "Show",
+                               "Hide", "Merge", "Split", "Export", "Import", "Protect", "Rotate", "Group", "Créer",
+                               "Sélectionner", "Zoom"};
+    const QStringList nouns = {"Table", "Row", "Column", "Cell", "Picture", "Chart", "Comment", "Page", "Section",
+                               "Header", "Footer", "Style", "Shape", "Text Box", "Hyperlink", "Bookmark", "Équation",
+                               "Symbol", "Footnote", "Caption", "Index", "Citation", "Watermark", "Border", "Margin"};
+    const QStringList qualifiers = {"", "Above", "Below", "Left", "Right", "All", "Selection", "Painter", "Options",
+                                    "Settings", "Layout", "Properties", "Gallery", "Wizard", "Preview", "Pane", "Mode",
+                                    "Rules", "Tools", "Format"};
+    const QStringList synonyms = {"add", "remove", "change", "duplicate", "place", "line up", "order", "narrow",
+                                  "display", "conceal", "combine", "divide", "save as", "open", "lock", "turn",
+                                  "gather", "make", "choose", "magnify"};
+
+    for (int i = 0; i < 10000; i++) {
+        int verb = i % verbs.size();
+        int noun = (i / verbs.size()) % nouns.size();
+        int qualifier = (i / (verbs.size() * nouns.size())) % qualifiers.size();
+        labels->append(QString("%1 %2 %3").arg(verbs[verb], nouns[noun], qualifiers[qualifier]).trimmed());
+        keywords->append(synonyms[verb]);
+    }
+}
+
+void searchBench(Runner &runner)
+{
+    QStringList labels;
+    QStringList keywords;
+    makeCommands(&labels, &keywords);
+
+    QJsonObject params;
+    params["commands"] = labels.size();
+
+    runner.run("search.build", params, [&]() {
+        CommandIndex index;
+        for (int i = 0; i < labels.size(); i++)
+            index.addCommand(CommandId(i), labels[i], QStringList(keywords[i]));
+        return qint64(0);
+    });
+
+    CommandIndex index;
+    for (int i = 0; i < labels.size(); i++)
+        index.addCommand(CommandId(i), labels[i], QStringList(keywords[i]));
+
+    int updated = 0;
+    runner.run("search.update", params, [&]() {
+        CommandId command = CommandId(updated++ % labels.size());
+        index.removeCommand(command);
+        index.addCommand(command, labels[command], QStringList(keywords[command]));
+        return qint64(0);
+    });
+
+    // Every keystroke of a few queries, against the substring scan of every label
+    const QStringList queries = {"format painter", "insert table row", "sel", "equation", "zoom pre", "row above"};
+    for (const QString &query : queries) {
+        for (int length = 1; length <= query.size(); length++) {
+            const QString typed = query.left(length);
+            if (typed.endsWith(' '))
+                continue;
+
+            QJsonObject keystroke = params;
+            keystroke["query"] = query;
+            keystroke["typed"] = length;
+            keystroke["hits"] = int(index.search(typed, 10).size());
+
+            runner.run("search.index", keystroke, [&]() {
+                index.search(typed, 10);
+                return qint64(0);
+            });
+            runner.run("search.scan", keystroke, [&]() {
+                QStringList found;
+                for (const QString &label : labels) {
+                    if (label.contains(typed, Qt::CaseInsensitive))
+                        found.append(label);
+                }
+                return qint64(0);
+            });
+        }
+    }
+}
+
+}
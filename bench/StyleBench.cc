@@ -0,0 +1,219 @@
+#include "Bench.hh"
+
+#include <RibbonStyle/Cache.hh>
+#include <RibbonStyle/Flat.hh>
+#include <RibbonStyle/IconAtlas.hh>
+#include <RibbonStyle/Registry.hh>
+
+#include <QPainter>
+
+#include <vector>
+
+using namespace RibbonUI::RibbonStyle;
+
+namespace Bench {
+
+static const char* stateName(ButtonState state)
+{
+    switch (state) {
+    case NORMAL: return "normal";
+    case HOVER: return "hover";
+    case ACTIVE: return "active";
+    case DISABLED: return "disabled";
+    }
+    return "unknown";
+}
+
+static QPixmap makeIcon(qreal dpr)
+{
+    QPixmap icon(QSize(32, 32) * dpr);
+    icon.setDevicePixelRatio(dpr);
+    icon.fill(Qt::transparent);
+
+    QPainter p(&icon);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setBrush(QColor(200, 60, 40));
+    p.setPen(Qt::NoPen);
+    p.drawEllipse(QRect(2, 2, 28, 28));
+    return icon;
+}
+
+// Packing of a ribbon worth of icons at the usual sizes and ratios, and batched against separate drawing
+static void atlasBench(Runner &runner)
+{
+    const int iconCounts[] = {64, 256, 1024};
+    const QList<qreal> ratios = {1.0, 1.5, 2.0};
+
+    for (int count : iconCounts) {
+        std::vector<QPixmap> icons;
+        for (int i = 0; i < count; i++)
+            icons.push_back(makeIcon(2.0));
+
+        IconAtlas atlas;
+        std::vector<IconHandle> handles;
+        for (qreal dpr : ratios) {
+            for (const QPixmap &icon : icons) {
+                handles.push_back(atlas.add(icon, QSize(16, 16), dpr));
+                handles.push_back(atlas.add(icon, QSize(32, 32), dpr));
+            }
+        }
+
+        IconAtlasStats stats = atlas.stats();
+        QJsonObject params;
+        params["icons"] = count;
+
+        QJsonObject result;
+        result["entries"] = stats.icons;
+        result["sheets"] = stats.sheets;
+        result["efficiency"] = stats.efficiency();
+        result["bytes"] = double(stats.bytes);
+        runner.add("atlas.pack", params, result);
+
+        QImage target(1920, 200, QImage::Format_ARGB32_Premultiplied);
+        runner.run("atlas.paint.separate", params, [&]() {
+            QPainter p(&target);
+            for (int i = 0; i < count; i++)
+                p.drawPixmap(QRect((i * 34) % 1900, (i / 56) * 34 % 180, 32, 32), icons[i]);
+            return qint64(0);
+        });
+        runner.run("atlas.paint.batched", params, [&]() {
+            QPainter p(&target);
+            IconBatch batch;
+            for (int i = 0; i < count; i++)
+                batch.add(QRectF((i * 34) % 1900, (i / 56) * 34 % 180, 32, 32), handles[2 * i + 1]);
+            batch.flush(p);
+            return qint64(0);
+        });
+    }
+}
+
+// Window resize sweep: every width through a cache (one pixmap by size) against nine-slice painting (one
+// template by state)
+static void resizeBench(Runner &runner)
+{
+    const QList<ButtonState> states = {NORMAL, HOVER, ACTIVE, DISABLED};
+    const QList<qreal> ratios = {1.0, 2.0};
+
+    for (qreal dpr : ratios) {
+        QJsonObject params;
+        params["dpr"] = dpr;
+        params["widths"] = 200;
+
+        FlatStyle flat;
+        flat.setDevicePixelRatio(dpr);
+        PixmapCache cache(256 * 1024 * 1024);
+        CachedStyle cached(&flat, &cache);
+        QImage target(QSize(460, 66) * dpr, QImage::Format_ARGB32_Premultiplied);
+        target.setDevicePixelRatio(dpr);
+
+        runner.run("resize.cached", params, [&]() {
+            QPainter p(&target);
+            for (int width = 60; width < 460; width += 2)
+                for (ButtonState state : states)
+                    p.drawPixmap(0, 0, cached.drawButton(QSize(width, 66), state, "Paste", QPixmap(), QSize(width, 66)));
+            return qint64(0);
+        });
+        runner.run("resize.nineslice", params, [&]() {
+            QPainter p(&target);
+            for (int width = 60; width < 460; width += 2)
+                for (ButtonState state : states)
+                    flat.paintButton(p, QRect(0, 0, width, 66), state, "Paste");
+            return qint64(0);
+        });
+
+        QJsonObject result;
+        result["cached_bytes"] = double(cache.stats().bytes);
+        result["cached_entries"] = cache.stats().entries;
+        result["template_bytes"] = double(flat.templateBytes());
+        result["templates"] = flat.templateCount();
+        runner.add("resize.memory", params, result);
+    }
+}
+
+// Memory of document windows drawing the same ribbon, each with its own cached style or through the registry
+static void registryBench(Runner &runner)
+{
+    const int windowCounts[] = {1, 4, 16};
+    const QStringList labels = {"Paste", "Cut", "Copy", "Format Painter", "Bold", "Italic", "Underline", "Find"};
+
+    for (int windows : windowCounts) {
+        QJsonObject params;
+        params["windows"] = windows;
+
+        qint64 separate = 0;
+        for (int w = 0; w < windows; w++) {
+            FlatStyle flat;
+            CachedStyle cached(&flat);
+            for (const QString &label : labels) {
+                cached.drawButton(QSize(0, 66), NORMAL, label);
+                cached.drawTab(QSize(0, 22), NORMAL, label);
+            }
+            separate += cached.cache()->stats().bytes;
+        }
+
+        StyleRegistry &registry = StyleRegistry::shared();
+        std::vector<int> owners(windows);
+        for (int &owner : owners) {
+            CachedStyle* style = registry.acquire("flat", &owner);
+            for (const QString &label : labels) {
+                style->drawButton(QSize(0, 66), NORMAL, label);
+                style->drawTab(QSize(0, 22), NORMAL, label);
+            }
+        }
+        StyleMemoryReport global = registry.report();
+        StyleMemoryReport window = registry.report(&owners[0]);
+        for (int &owner : owners)
+            registry.releaseAll(&owner);
+
+        QJsonObject result;
+        result["separate_bytes"] = double(separate);
+        result["shared_bytes"] = double(global.sharedBytes);
+        result["unique_bytes"] = double(global.uniqueBytes);
+        result["window_attributed_bytes"] = double(window.attributedBytes);
+        runner.add("registry.memory", params, result);
+    }
+}
+
+void styleBench(Runner &runner)
+{
+    const QList<QSize> sizes = {QSize(24, 24), QSize(64, 24), QSize(96, 66), QSize(160, 90)};
+    const QList<ButtonState> states = {NORMAL, HOVER, ACTIVE, DISABLED};
+    const QStringList labels = {QString(), "Paste", "Format Painter", "Insert Table of Contents Entry"};
+    const QList<qreal> ratios = {1.0, 1.5, 2.0};
+
+    FlatStyle style;
+
+    for (qreal dpr : ratios) {
+        style.setDevicePixelRatio(dpr);
+        const QPixmap icons[2] = {QPixmap(), makeIcon(dpr)};
+
+        for (const QSize &size : sizes) {
+            for (ButtonState state : states) {
+                for (const QString &label : labels) {
+                    for (const QPixmap &icon : icons) {
+                        QJsonObject params;
+                        params["width"] = size.width();
+                        params["height"] = size.height();
+                        params["state"] = stateName(state);
+                        params["label_length"] = label.size();
+                        params["icon"] = !icon.isNull();
+                        params["dpr"] = dpr;
+
+                        runner.run("flat.drawTab", params, [&]() {
+                            return PixmapCache::pixmapBytes(style.drawTab(size, state, label, icon));
+                        });
+                        runner.run("flat.drawButton", params, [&]() {
+                            return PixmapCache::pixmapBytes(style.drawButton(size, state, label, icon));
+                        });
+                    }
+                }
+            }
+        }
+    }
+
+    atlasBench(runner);
+    resizeBench(runner);
+    registryBench(runner);
+}
+
+}
@@ -0,0 +1,90 @@
+// RibbonBench: headless benchmarks of the ribbon rendering code.
+//
+// Usage: RibbonBench [--suite name]... [--min-time ms] [--output file]
+// Results are written as JSON (stdout by default).
+
+#include "Bench.hh"
+
+#include <QApplication>
+#include <QFile>
+#include <QJsonDocument>
+
+#include <cstdio>
+
+struct Suite {
+    const char* name;
+    void (*run)(Bench::Runner &runner);
+};
+
+static const Suite gSuites[] = {
+    {"style", &Bench::styleBench},
+    {"hittest", &Bench::hitTestBench},
+    {"layout", &Bench::layoutBench},
+    {"policy", &Bench::policyBench},
+    {"compare", &Bench::compareBench},
+    {"definition", &Bench::definitionBench},
+    {"commands", &Bench::commandBench},
+    {"search", &Bench::searchBench},
+};
+
+int main(int argc, char* argv[])
+{
+#ifdef Q_OS_LINUX
+    // Run without display server unless the caller asked for a platform
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+    QApplication app(argc, argv);
+
+    Bench::Options options;
+    QStringList selected;
+    QString output;
+
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); i++) {
+        if (args[i] == "--suite" && i + 1 < args.size())
+            selected << args[++i];
+        else if (args[i] == "--min-time" && i + 1 < args.size())
+            options.minTimeNs = args[++i].toLongLong() * 1000 * 1000;
+        else if (args[i] == "--output" && i + 1 < args.size())
+            output = args[++i];
+        else {
+            fprintf(stderr, "usage: %s [--suite name]... [--min-time ms] [--output file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    QJsonObject suites;
+    QJsonArray failures;
+    for (const Suite &suite : gSuites) {
+        if (!selected.isEmpty() && !selected.contains(suite.name))
+            continue;
+        Bench::Runner runner(options);
+        suite.run(runner);
+        suites[suite.name] = runner.results();
+        for (const QString &failure : runner.failures())
+            failures.append(QString("%1: %2").arg(suite.name, failure));
+    }
+
+    QJsonObject root;
+    root["qt_version"] = qVersion();
+    root["platform"] = QGuiApplication::platformName();
+    root["suites"] = suites;
+    root["failures"] = failures;
+    QByteArray json = QJsonDocument(root).toJson();
+
+    // Results are written even when a check failed, the status tells
+    const int status = failures.isEmpty() ? 0 : 1;
+    if (output.isEmpty()) {
+        fwrite(json.constData(), 1, json.size(), stdout);
+        return status;
+    }
+
+    QFile file(output);
+    if (!file.open(QIODevice::WriteOnly)) {
+        fprintf(stderr, "cannot write %s\n", qPrintable(output));
+        return 1;
+    }
+    file.write(json);
+    return status;
+}
@@ -0,0 +1,47 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef CaptionIndex_HH_
+#define CaptionIndex_HH_
+
+#include <QRect>
+
+#include <utility>
+#include <vector>
+
+namespace CustomWindow {
+
+// Point location over the union of caption rectangles.
+// The plane is cut in horizontal slabs at every rectangle edge, each slab storing the merged x intervals
+// covering it, so a lookup is two binary searches.
+class CaptionIndex {
+public:
+	// Rebuild the index (bounds are inclusive: a rect covers [x, x + width] x [y, y + height])
+	void build(const std::vector<QRect>& rects);
+	void clear(void);
+
+	bool contains(int x, int y) const;
+	bool isEmpty(void) const;
+
+private:
+	std::vector<int> mSlabTop;
+	std::vector<int> mSlabFirst;
+	std::vector<std::pair<int, int>> mIntervals;
+};
+
+}
+
+#endif
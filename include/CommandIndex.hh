@@ -0,0 +1,75 @@
+#pragma once
+
+#include <RibbonTab.hh>
+
+#include <QString>
+#include <QStringList>
+
+#include <unordered_map>
+#include <vector>
+
+namespace RibbonUI {
+
+class RibbonDefinition;
+
+struct SearchHit {
+    CommandId command;
+    int score;
+};
+
+// Search of commands by label and keywords (synonyms, translations), for a "search commands" box.
+// Texts are case folded, without diacritics nor accelerator marks, and split into words. Each word is
+// indexed by its trigrams and by its first one and two characters; a query word of three characters or more
+// matches inside words, a shorter one only at the start of a word. Every query word must match.
+//
+// Commands are added and removed one at a time, a query only looks at the posting lists of its words.
+class CommandIndex {
+public:
+    CommandIndex(void);
+
+    // Add or replace a command
+    void addCommand(CommandId command, const QString &label, const QStringList &keywords = QStringList());
+    void removeCommand(CommandId command);
+    bool contains(CommandId command) const;
+    QString label(CommandId command) const;
+    int size(void) const;
+    void clear(void);
+
+    // Commands of a definition (labels), or the controls of a tab bound to a command
+    void addCommands(const RibbonDefinition &definition);
+    void addCommands(const Tab &tab);
+    void removeCommands(const Tab &tab);
+
+    // Best matches first: whole word before word start before inside a word, label before keywords, then
+    // shorter labels
+    std::vector<SearchHit> search(const QString &query, int limit = 10) const;
+
+    static QString normalize(const QString &text);
+
+private:
+    struct Entry {
+        CommandId command;
+        QString label;
+        std::vector<QString> words;
+        // Words from this index on come from the keywords
+        int keywordWords;
+        std::vector<quint64> keys;
+        bool used;
+    };
+
+    static std::vector<QString> split(const QString &text);
+    // Prefixes of one and two characters, and trigrams
+    static void addKeys(const QString &word, std::vector<quint64>* keys);
+    static void addTrigrams(const QString &word, std::vector<quint64>* keys);
+    static quint64 key(const QChar* chars, int length);
+
+    int matchScore(const Entry &entry, const QString &word) const;
+
+    std::vector<Entry> mEntries;
+    std::vector<int> mFree;
+    std::unordered_map<CommandId, int> mSlots;
+    // Sorted entry slots by trigram or word prefix
+    std::unordered_map<quint64, std::vector<int>> mPostings;
+};
+
+}
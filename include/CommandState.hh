@@ -0,0 +1,87 @@
+#pragma once
+
+#include <RibbonTab.hh>
+
+#include <QMutex>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace RibbonUI {
+
+// State of a command, shared by every control bound to it
+struct CommandState {
+    bool enabled = true;
+    bool checked = false;
+    // 0 for no badge, at most 65535
+    int badge = 0;
+
+    // Disabled wins over checked, which is displayed as ACTIVE
+    RibbonStyle::ButtonState buttonState(void) const;
+    bool operator==(const CommandState &other) const;
+    bool operator!=(const CommandState &other) const { return !(*this == other); }
+};
+
+struct CommandChange {
+    CommandId command;
+    CommandState previous;
+    CommandState current;
+};
+
+struct CommandStateStats {
+    quint64 drains = 0;
+    // Commands reported changed by drain(), and dirty commands found back to their drained state
+    quint64 changes = 0;
+    quint64 unchanged = 0;
+};
+
+// Command states updated from any thread without lock and collected by the GUI thread once per frame.
+// Each command is an atomic word; an update which changes it sets the command bit in an atomic dirty
+// bitmap, and the first update after a drain calls the notifier (to post one event to the GUI thread), the
+// only step taking a lock.
+// drain() then reports each dirty command once, with its latest state: any number of updates between two
+// frames coalesces into at most one change by command, and none if it came back to the previous state.
+class CommandStateStore {
+public:
+    explicit CommandStateStore(int capacity);
+
+    int capacity(void) const;
+
+    // Any thread. Commands out of the capacity are ignored.
+    void setEnabled(CommandId command, bool enabled);
+    void setChecked(CommandId command, bool checked);
+    void setBadge(CommandId command, int badge);
+    void setState(CommandId command, const CommandState &state);
+    CommandState state(CommandId command) const;
+
+    // Called from the updating thread, at most once between two drains. A store has one consumer: return false
+    // if another notifier is set (unset it with an empty function first). Once unset, the notifier is no longer
+    // running in any thread.
+    bool setNotifier(const std::function<void(void)> &notifier);
+    bool isPending(void) const;
+
+    // One thread at a time (the GUI thread): append the changes since the previous drain, return their count
+    int drain(std::vector<CommandChange>* changes);
+    CommandStateStats stats(void) const;
+
+private:
+    static quint32 pack(const CommandState &state);
+    static CommandState unpack(quint32 word);
+    void modify(CommandId command, quint32 mask, quint32 bits);
+
+    int mCapacity;
+    std::unique_ptr<std::atomic<quint32>[]> mWords;
+    std::unique_ptr<std::atomic<quint64>[]> mDirty;
+    std::atomic<bool> mPending;
+    // Locked once per drain by the updating threads
+    QMutex mNotifierMutex;
+    std::function<void(void)> mNotifier;
+
+    // Owned by the draining thread: state of the commands as last reported
+    std::vector<quint32> mDrained;
+    CommandStateStats mStats;
+};
+
+}
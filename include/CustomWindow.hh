@@ -24,27 +24,24 @@
 #include <QStyle>
 #include <QMargins>
 
-#ifdef Q_OS_WIN
-    #include <Windows.h>
-    #include <WindowsX.h>
-    #include <Uxtheme.h>
-    #include <dwmapi.h>
-    #include <vector>
+#include <vector>
+
+#include "CaptionIndex.hh"
+#include "FrameLogic.hh"
+#include "FrameStats.hh"
+#include "StartupTrace.hh"
 
+#ifdef Q_OS_WIN
 #if (QT_VERSION == QT_VERSION_CHECK(5, 11, 1))
 #error Qt bug for version 5.11.1. See https://bugreports.qt.io/browse/QTBUG-69074?jql=project%20%3D%20QTBUG%20AND%20text%20~%20nativeEvent%20AND%20affectedVersion%20%3D%205.11.1 for more information
 #endif
 
 #endif
 
-
-#define CALCSIZE_USE_BORDER     0x0001
-#define CALCSIZE_USE_MARGIN     0x0002
-#define CALCSIZE_USE_TITLEBAR   0x0004
-#define CALCSIZE_DEFAULT        0x0007
-
 namespace CustomWindow {
 
+class FrameBackend;
+
 enum Sizing {
     contentSizing,
     borderSizing,
@@ -52,7 +49,6 @@ enum Sizing {
 };
 
 class CustomWindow : public QWidget {
-#ifdef Q_OS_WIN
 	Q_OBJECT
 
 	Q_PROPERTY(bool frameRemoved READ isFrameRemoved WRITE setFrameRemoved)
@@ -60,7 +56,6 @@ class CustomWindow : public QWidget {
 	Q_PROPERTY(int borderSize READ borderSize WRITE setBorderSize)
 	Q_PROPERTY(int titleBarSize READ titleBarSize WRITE setTitleBarSize)
 	Q_PROPERTY(int geometryFlags READ geometryFlags WRITE setGeometryFlags)
-#endif
 
 public:
     CustomWindow(QWidget* parent = nullptr, Qt::WindowFlags flags = Qt::Window);
@@ -86,6 +81,9 @@ public:
 	void setExtraMargins(const QMargins& margins);
 	QMargins extraMargins(void) const;
 
+	// Border, title bar and style metrics used by the frame
+	const FrameMetrics& frameMetrics(void) const;
+
 	// Access to border size (need to have DWM composition enabled)
 	void setBorderSize(int size);
 	int borderSize(void) const;
@@ -114,6 +112,12 @@ public:
     void declareCaption(const QWidget* widget);
 	void removeCaption(const QWidget* widget);
 
+	// Frame zone under pos (relative to the top left corner of the window frame)
+	HitZone hitTest(const QPoint& pos);
+
+	// Timings of the painting and event handlers, null unless built with RIBBON_INSTRUMENTATION
+	FrameStats* frameStats(void);
+
 	// Overload layout system for apply geometry calculator to layout form
 	void setLayout(QLayout* layout);
 
@@ -131,43 +135,62 @@ signals:
 	void compositionChanged(void);
 
 
-#ifdef Q_OS_WIN
 protected:
+#ifdef Q_OS_WIN
     bool nativeEvent(const QByteArray &eventType, void* message, long* result);
-	void paintEvent(QPaintEvent*);
+#endif
+	void paintEvent(QPaintEvent* eve);
 	void mousePressEvent(QMouseEvent* eve);
 	void mouseMoveEvent(QMouseEvent* eve);
 	void mouseReleaseEvent(QMouseEvent* eve);
+	void resizeEvent(QResizeEvent* eve);
+	void changeEvent(QEvent* eve);
+	bool event(QEvent* eve);
+	bool eventFilter(QObject* watched, QEvent* eve);
 
 private:
-    void updateMargins(HWND hWnd = nullptr);
-    void updateFrame(HWND hWnd = nullptr);
-	long ncHitTest(MSG* wMsg);
-	void paintWinFrame(void);
+    void updateMargins(void);
+    void updateFrame(void);
+	void paintWinFrame(const QRegion& dirty);
 	
 	void ncMouseMove(int cx, int cy);
 	void ncMousePress(int cx, int cy);
 	void ncMouseRelease(int cx, int cy);
 	bool hasControls(int cx, int cy);
+	void updateTitleBarGeometry(void);
+	void updateTitleBarButtons(QStyle::SubControl previous);
+	QRect titleBarButtonRect(QStyle::SubControl button) const;
 
     bool isCaption(int cx, int cy) const;
+	void updateCaptionIndex(void) const;
+	// Install (or remove) our event filter on the caption and its ancestors below the window
+	void watchCaption(const QWidget* widget, bool watch);
 
 	void updateLayoutMargins(void);
+	void invalidateFrameMetrics(void);
 
-	void EnableWindowBlur(void);
-	void DisableWindowBlur(void);
+	FrameBackend* mBackend;
 
 	QMargins mMargins;
 	QMargins mLayoutMargins;
 
-    POINT mStartPos;
+    QPoint mStartPos;
 	int mBorderSize;
     int mTitleBarSize;
+	mutable FrameMetrics mFrameMetrics;
+	mutable bool mFrameMetricsDirty = true;
 
     std::vector<const QWidget*> mCaptions;
+	mutable CaptionIndex mCaptionIndex;
+	mutable bool mCaptionIndexDirty = false;
+
+	// Title bar button rects, recomputed on resize, style, state or theme change
+	TitleBarControls::Buttons mHitButtons;
+	TitleBarControls::Buttons mPaintButtons;
+	bool mTitleBarGeometryDirty = true;
+
+	TitleBarControls mTitleBar;
 
-	QStyle::SubControl mTitleBarHover;
-	QStyle::State mTitleBarState;
     Sizing mSizingMethod;
 	int mGeometryFlags = CALCSIZE_DEFAULT;
 	bool mFrameRemoved;
@@ -176,7 +199,9 @@ private:
 	qreal mBlurBehindOpacity;
 
 	QColor mBackgroundColor;
-	
+
+#ifdef RIBBON_INSTRUMENTATION
+	FrameStats mFrameStats;
 #endif
 };
 
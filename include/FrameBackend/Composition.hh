@@ -0,0 +1,57 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FrameBackend_Composition_HH_
+#define FrameBackend_Composition_HH_
+
+#include <QColor>
+#include <QVector>
+#include <qwindowdefs.h>
+
+namespace CustomWindow {
+
+// Values of the undocumented ACCENT_STATE enum of SetWindowCompositionAttribute
+enum AccentState {
+	AccentDisabled = 0,
+	AccentGradient = 1,
+	AccentTransparentGradient = 2,
+	AccentBlurBehind = 3,
+	AccentAcrylicBlurBehind = 4
+};
+
+struct AccentPolicy {
+	AccentState state = AccentDisabled;
+	int flags = 0;
+	// Gradient and acrylic tint
+	QColor color;
+	int animationId = 0;
+};
+
+// Access to the window composition attributes (blur, acrylic...) of Windows 10.
+// The entry point is resolved once, on first use, from any thread. Other platforms get a stub doing nothing.
+class Composition {
+public:
+	static bool isAvailable(void);
+
+	// Return false if the attribute can't be set
+	static bool setAccent(WId window, const AccentPolicy& policy);
+	// Apply the same policy to all windows, return the number of windows changed
+	static int setAccent(const QVector<WId>& windows, const AccentPolicy& policy);
+};
+
+}
+
+#endif
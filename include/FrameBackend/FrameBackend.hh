@@ -0,0 +1,62 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FrameBackend_HH_
+#define FrameBackend_HH_
+
+#include <QMargins>
+#include <QRect>
+
+class QWidget;
+
+namespace CustomWindow {
+
+// Platform specific part of a CustomWindow: everything talking to the window manager
+class FrameBackend {
+public:
+	virtual ~FrameBackend();
+
+	// Backend of the running platform (Win32 on Windows, Qt elsewhere)
+	static FrameBackend* create(QWidget* window);
+
+	// True if the system asks the window for hit tests (the backend handles move and resize itself)
+	virtual bool hasNativeHitTest(void) const = 0;
+
+	// Window rect including the non client area, in global coordinates
+	virtual QRect frameGeometry(void) const = 0;
+
+	// Apply frame removal and the area of the frame drawn by the compositor
+	virtual void updateFrame(bool frameRemoved) = 0;
+	virtual void updateMargins(const QMargins& margins) = 0;
+
+	// Start an interactive move or resize, return false if the platform can't do it
+	virtual bool startSystemMove(void) = 0;
+	virtual bool startSystemResize(Qt::Edges edges) = 0;
+
+	virtual bool hasSystemMenu(void) const = 0;
+	virtual void setSystemMenu(bool visible) = 0;
+	virtual void setResizable(bool resizable) = 0;
+	virtual void setBlurBehind(bool enabled) = 0;
+
+protected:
+	explicit FrameBackend(QWidget* window);
+
+	QWidget* mWindow;
+};
+
+}
+
+#endif
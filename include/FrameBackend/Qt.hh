@@ -0,0 +1,50 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FrameBackend_Qt_HH_
+#define FrameBackend_Qt_HH_
+
+#include <FrameBackend/FrameBackend.hh>
+
+namespace CustomWindow {
+
+// Generic backend: frameless Qt window, move and resize done by the window manager when Qt can ask it
+// (Qt 5.15 and later) or by CustomWindow itself.
+class QtFrameBackend : public FrameBackend {
+public:
+	explicit QtFrameBackend(QWidget* window);
+
+	bool hasNativeHitTest(void) const override;
+	QRect frameGeometry(void) const override;
+
+	void updateFrame(bool frameRemoved) override;
+	void updateMargins(const QMargins& margins) override;
+
+	bool startSystemMove(void) override;
+	bool startSystemResize(Qt::Edges edges) override;
+
+	bool hasSystemMenu(void) const override;
+	void setSystemMenu(bool visible) override;
+	void setResizable(bool resizable) override;
+	void setBlurBehind(bool enabled) override;
+
+private:
+	void setWindowFlag(Qt::WindowType flag, bool on);
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FrameBackend_SystemState_HH_
+#define FrameBackend_SystemState_HH_
+
+namespace CustomWindow {
+
+// Source of the composition and theme state (the platform one, or a fake one for tests)
+class SystemStateProvider {
+public:
+	virtual ~SystemStateProvider();
+
+	virtual bool queryCompositionEnabled(void) = 0;
+	virtual bool queryThemeActive(void) = 0;
+};
+
+// Process wide cache of the composition and theme state. Reads are a single atomic load, usable from any
+// thread; the state is queried again only by refresh() (on WM_DWMCOMPOSITIONCHANGED or WM_THEMECHANGED).
+class SystemState {
+public:
+	static bool isCompositionEnabled(void);
+	static bool isThemeActive(void);
+
+	static void refresh(void);
+
+	// Replace the provider (not owned), nullptr restores the platform one. The state is refreshed.
+	static void setProvider(SystemStateProvider* provider);
+};
+
+}
+
+#endif
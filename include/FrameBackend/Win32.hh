@@ -0,0 +1,67 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// Based on Adaedra QDwm
+// Copyright (C) 2011 Adaedra
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FrameBackend_Win32_HH_
+#define FrameBackend_Win32_HH_
+
+#include <FrameBackend/FrameBackend.hh>
+#include <FrameLogic.hh>
+
+#ifdef Q_OS_WIN
+    #include <Windows.h>
+    #include <WindowsX.h>
+    #include <Uxtheme.h>
+    #include <dwmapi.h>
+
+namespace CustomWindow {
+
+// DWM backend: the window keeps its native frame, extended into the client area, and answers WM_NCHITTEST
+class Win32FrameBackend : public FrameBackend {
+public:
+	explicit Win32FrameBackend(QWidget* window);
+
+	static bool queryCompositionEnabled(void);
+	static bool queryThemeActive(void);
+
+	// Convert a zone to the WM_NCHITTEST result
+	static long toNative(HitZone zone);
+
+	bool hasNativeHitTest(void) const override;
+	QRect frameGeometry(void) const override;
+
+	void updateFrame(bool frameRemoved) override;
+	void updateMargins(const QMargins& margins) override;
+
+	bool startSystemMove(void) override;
+	bool startSystemResize(Qt::Edges edges) override;
+
+	bool hasSystemMenu(void) const override;
+	void setSystemMenu(bool visible) override;
+	void setResizable(bool resizable) override;
+	void setBlurBehind(bool enabled) override;
+
+private:
+	HWND handle(void) const;
+};
+
+}
+
+#endif
+
+#endif
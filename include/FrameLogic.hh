@@ -0,0 +1,104 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FrameLogic_HH_
+#define FrameLogic_HH_
+
+#include <QMargins>
+#include <QRect>
+#include <QStyle>
+
+#define CALCSIZE_USE_BORDER     0x0001
+#define CALCSIZE_USE_MARGIN     0x0002
+#define CALCSIZE_USE_TITLEBAR   0x0004
+#define CALCSIZE_DEFAULT        0x0007
+
+namespace CustomWindow {
+
+// Platform independent equivalent of the Win32 HT* values
+enum HitZone {
+	HitNowhere,
+	HitClient,
+	HitCaption,
+	HitLeft,
+	HitRight,
+	HitTop,
+	HitTopLeft,
+	HitTopRight,
+	HitBottom,
+	HitBottomLeft,
+	HitBottomRight
+};
+
+// Frame metrics resolved from the style, computed once per style, DPI or theme change
+struct FrameMetrics {
+	int border;
+	int titleBar;
+	int mdiFrameWidth;
+	int titleBarHeight;
+};
+
+namespace FrameLogic {
+
+// Client area of a window of the given size. border, titleBar and margins must be 0 if not used.
+QRect clientGeometry(const QSize& size, const QMargins& margins, int border, int titleBar);
+
+// Layout contents margins placing the layout inside the client area
+QMargins layoutMargins(const QSize& size, const QRect& client, const QMargins& extra);
+
+// Frame zone under pos (relative to the top left corner of the window frame)
+HitZone hitZone(const QPoint& pos, const QSize& frame, int border, int titleBar);
+
+// Edges to use for a system resize from the given zone
+Qt::Edges resizeEdges(HitZone zone);
+Qt::CursorShape cursorShape(HitZone zone);
+
+}
+
+// Hover and press state machine of the title bar buttons
+class TitleBarControls {
+public:
+	struct Buttons {
+		QRect close;
+		QRect max;
+		QRect min;
+		QRect normal;
+	};
+
+	void setButtons(const Buttons& buttons);
+	const Buttons& buttons(void) const;
+
+	// Return true if hover or state changed
+	bool move(const QPoint& pos, bool maximized);
+	bool press(void);
+	// Return the clicked button, SC_None if the release ends no click
+	QStyle::SubControl release(void);
+	void reset(void);
+
+	QStyle::SubControl hover(void) const;
+	QStyle::State state(void) const;
+
+private:
+	bool setHover(QStyle::SubControl hover, QStyle::State state);
+
+	Buttons mButtons;
+	QStyle::SubControl mHover = QStyle::SC_None;
+	QStyle::State mState = QStyle::State_None;
+};
+
+}
+
+#endif
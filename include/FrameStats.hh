@@ -0,0 +1,120 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FrameStats_HH_
+#define FrameStats_HH_
+
+#include <QJsonObject>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+
+// Probes of the CustomWindow entry points. Without RIBBON_INSTRUMENTATION (CMake option) they compile to
+// nothing and CustomWindow has no statistics.
+#ifdef RIBBON_INSTRUMENTATION
+	#define FRAME_PROBE(stats, probe) ::CustomWindow::FrameStats::Scope frameProbe(stats, ::CustomWindow::probe)
+	#define FRAME_MESSAGE(stats, message) (stats).countMessage(message)
+#else
+	#define FRAME_PROBE(stats, probe) do {} while (0)
+	#define FRAME_MESSAGE(stats, message) do {} while (0)
+#endif
+
+namespace CustomWindow {
+
+enum FrameProbe {
+	ProbePaintEvent,
+	ProbePaintWinFrame,
+	ProbeNativeEvent,
+	ProbeHitTest,
+	ProbeCount
+};
+
+// Latency histogram with log2 buckets (bucket i counts the samples in [2^i, 2^(i+1)) ns). Recording is lock
+// free and may happen from any thread.
+class LatencyHistogram {
+public:
+	static const int Buckets = 40;
+
+	LatencyHistogram(void);
+
+	void record(quint64 ns);
+	void reset(void);
+
+	quint64 count(void) const;
+	quint64 total(void) const;
+	quint64 max(void) const;
+	quint64 bucket(int index) const;
+	// Upper bound of the bucket holding the given fraction of the samples
+	quint64 percentile(double p) const;
+
+	QJsonObject toJson(void) const;
+
+private:
+	std::atomic<quint64> mBuckets[Buckets];
+	std::atomic<quint64> mCount;
+	std::atomic<quint64> mTotal;
+	std::atomic<quint64> mMax;
+};
+
+// Counters and latency histograms of a window
+class FrameStats {
+public:
+	// Native messages counted one by one below this value, together above it
+	static const unsigned int MessageCount = 0x0400;
+
+	explicit FrameStats(const QString& name = QString());
+	~FrameStats();
+
+	void setName(const QString& name);
+	QString name(void) const;
+
+	LatencyHistogram& histogram(FrameProbe probe);
+	const LatencyHistogram& histogram(FrameProbe probe) const;
+
+	void countMessage(unsigned int message);
+	quint64 messageCount(unsigned int message) const;
+
+	void reset(void);
+	QJsonObject toJson(void) const;
+
+	static const char* probeName(FrameProbe probe);
+
+	// Statistics of every living window
+	static QJsonObject dumpAll(void);
+	// Write dumpAll() to the file every msec milliseconds (0 stops)
+	static void setPeriodicDump(const QString& file, int msec);
+
+	// Time the enclosing block
+	class Scope {
+	public:
+		Scope(FrameStats& stats, FrameProbe probe);
+		~Scope();
+
+	private:
+		LatencyHistogram& mHistogram;
+		std::chrono::steady_clock::time_point mStart;
+	};
+
+private:
+	QString mName;
+	LatencyHistogram mHistograms[ProbeCount];
+	std::atomic<quint64> mMessages[MessageCount + 1];
+};
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <RibbonTab.hh>
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QString>
+
+#include <functional>
+#include <memory>
+
+namespace RibbonUI {
+
+class Window;
+
+// Compiled ribbon description (tabs, groups and commands) loaded by mapping the file. Strings are stored
+// once, in UTF-16, and only copied out (without decoding) when they are asked for: returned strings remain
+// valid after close().
+//
+// File layout, little endian, every section aligned on 4 bytes:
+//   header, tab records, group records, command records, string records (offset, length), UTF-16 data
+// Tabs reference a range of groups and groups a range of commands, in file order.
+class RibbonDefinition {
+public:
+    static const quint32 Magic = 0x314e4252; // "RBN1"
+    static const quint32 Version = 1;
+
+    // Load a command icon by name
+    typedef std::function<QPixmap(const QString &name)> IconLoader;
+
+    RibbonDefinition(void);
+    ~RibbonDefinition();
+
+    // Map and check the file. On failure, errorString() tells why.
+    bool open(const QString &path);
+    // Same on bytes owned by the caller, which must outlive the definition
+    bool open(const uchar* data, qint64 size);
+    void close(void);
+    bool isOpen(void) const;
+    QString errorString(void) const;
+
+    int tabCount(void) const;
+    QString tabTitle(int tab) const;
+    int groupCount(int tab) const;
+    int commandCount(void) const;
+    // Commands of the whole definition, in file order (tab by tab, group by group)
+    QString commandId(int command) const;
+    QString commandLabel(int command) const;
+    QString commandIcon(int command) const;
+    ControlSize commandSize(int command) const;
+
+    // Fill a tab page with the groups and commands of a definition tab. Controls are bound to their command
+    // index (commandId() gives the name).
+    void build(int tab, Tab &out, const IconLoader &icons = IconLoader()) const;
+    // Register every tab in the window as a lazy page (built on first activation). The definition must stay
+    // open as long as the window may build pages.
+    void install(Window &window, const IconLoader &icons = IconLoader()) const;
+
+    // Compile the JSON source:
+    //   {"tabs": [{"title": "Home", "groups": [{"title": "Clipboard", "commands": [
+    //       {"id": "paste", "label": "Paste", "icon": "paste", "size": "large|medium|small"}]}]}]}
+    // Return an empty array on error, with the reason in error.
+    static QByteArray compile(const QJsonDocument &source, QString* error = nullptr);
+
+private:
+    struct Header;
+    struct TabRecord;
+    struct GroupRecord;
+    struct CommandRecord;
+    struct StringRecord;
+
+    bool validate(void);
+    QString string(quint32 index) const;
+    const Header &header(void) const;
+    const TabRecord* tabs(void) const;
+    const GroupRecord* groups(void) const;
+    const CommandRecord* commands(void) const;
+    const StringRecord* strings(void) const;
+
+    std::unique_ptr<QFile> mFile;
+    const uchar* mData;
+    qint64 mSize;
+    QString mError;
+};
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <RibbonStyle/Cache.hh>
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+
+#include <functional>
+#include <vector>
+
+namespace RibbonUI {
+
+class Tab;
+
+namespace RibbonStyle {
+
+struct AsyncRendererStats {
+    quint64 submitted = 0;
+    quint64 completed = 0;
+    // Requests refused because the queue was full
+    quint64 rejected = 0;
+    // Results dropped because the style changed while they were rendered
+    quint64 stale = 0;
+    // pixmap() calls served from the cache, and calls which had to render synchronously
+    quint64 hits = 0;
+    quint64 fallbacks = 0;
+};
+
+struct RenderRequest {
+    PixmapCache::Kind kind;
+    QSize minsize;
+    ButtonState state;
+    QString name;
+    QPixmap icon;
+    QSize maxsize;
+};
+
+// Pre-renders style pixmaps on a worker pool and stores them in the cache of a CachedStyle, so that the first
+// paint of a tab finds its buttons ready. Workers render QImage through the thread safe path of the wrapped
+// style; the conversion to QPixmap and the cache insertion happen on the GUI thread. Styles which are not
+// thread safe are rendered synchronously.
+//
+// The wrapped style must not be modified while requests are pending (results of a changed style are dropped).
+class AsyncRenderer : public QObject {
+public:
+    typedef std::function<void(const QPixmap &pixmap)> Callback;
+
+    explicit AsyncRenderer(CachedStyle* style, QObject* parent = nullptr);
+    ~AsyncRenderer();
+
+    void setWorkerCount(int count);
+    int workerCount(void) const;
+    // Maximal number of pending requests, further requests are rejected
+    void setQueueDepth(int depth);
+    int queueDepth(void) const;
+
+    // Render in background. callback is called from the GUI thread once the pixmap is in the cache (at once
+    // if it already is). Return false if the queue is full.
+    bool render(const RenderRequest &request, const Callback &callback = Callback());
+    // Every state of the controls of a laid out tab, as they are displayed. Return the accepted requests.
+    int prerender(const Tab &tab);
+
+    // Result for request: from the cache, or rendered synchronously when it isn't there yet
+    QPixmap pixmap(const RenderRequest &request);
+
+    // Wait for the pending requests and deliver their results
+    void waitForDone(void);
+
+    AsyncRendererStats stats(void) const;
+    void resetStats(void);
+
+protected:
+    bool event(QEvent* event) override;
+
+private:
+    class Job;
+
+    struct Pending {
+        RenderRequest request;
+        std::vector<Callback> callbacks;
+    };
+
+    struct Result {
+        PixmapCache::Key key;
+        QImage image;
+        quint64 revision;
+    };
+
+    PixmapCache::Key makeKey(const RenderRequest &request) const;
+    QPixmap drawSync(const RenderRequest &request);
+
+    // Called by the workers
+    void finished(const Result &result);
+    void deliver(void);
+
+    CachedStyle* mStyle;
+    QThreadPool mPool;
+    int mQueueDepth;
+    QHash<PixmapCache::Key, Pending> mPending;
+    AsyncRendererStats mStats;
+
+    QMutex mMutex;
+    // Finished by the workers, not delivered yet (guarded by mMutex)
+    std::vector<Result> mResults;
+};
+
+}
+
+}
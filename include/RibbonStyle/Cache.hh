@@ -0,0 +1,116 @@
+#pragma once
+
+#include <RibbonStyle/RibbonStyle.hh>
+
+#include <QHash>
+
+#include <list>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+struct PixmapCacheStats {
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+    qint64 bytes = 0;
+    int entries = 0;
+};
+
+// LRU cache of rendered style pixmaps, bounded by a byte budget. A cache can be shared by several styles.
+class PixmapCache {
+public:
+    enum Kind {
+        Tab,
+        Button
+    };
+
+    struct Key {
+        const RibbonStyle* style;
+        Kind kind;
+        ButtonState state;
+        QSize minsize;
+        QSize maxsize;
+        QString name;
+        // QPixmap::cacheKey or IconHandle::key
+        qint64 icon;
+        qreal dpr;
+
+        bool operator==(const Key &other) const;
+    };
+
+    explicit PixmapCache(qint64 budget = 16 * 1024 * 1024);
+
+    void setBudget(qint64 bytes);
+    qint64 budget(void) const;
+
+    // Return true and fill pixmap on hit (the entry become the most recently used)
+    bool find(const Key &key, QPixmap* pixmap);
+    // Lookup without touching the order or the statistics
+    bool contains(const Key &key) const;
+    void insert(const Key &key, const QPixmap &pixmap);
+
+    // Remove every entry, or only entries generated by the given style
+    void clear(void);
+    void clear(const RibbonStyle* style);
+
+    // Bytes held by the entries of a style
+    qint64 bytes(const RibbonStyle* style) const;
+
+    PixmapCacheStats stats(void) const;
+    void resetStats(void);
+
+    static qint64 pixmapBytes(const QPixmap &pixmap);
+
+private:
+    struct Entry {
+        Key key;
+        QPixmap pixmap;
+        qint64 bytes;
+    };
+
+    void trim(qint64 budget);
+
+    std::list<Entry> mEntries;
+    QHash<Key, std::list<Entry>::iterator> mIndex;
+    qint64 mBudget;
+    PixmapCacheStats mStats;
+};
+
+uint qHash(const PixmapCache::Key &key, uint seed = 0);
+
+// Style proxy serving drawTab and drawButton results from a PixmapCache
+class CachedStyle : public RibbonStyle {
+public:
+    // If cache is null, the style use its own cache
+    explicit CachedStyle(RibbonStyle* style, PixmapCache* cache = nullptr);
+    ~CachedStyle();
+
+    QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize()) override;
+    QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize()) override;
+    QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize = QSize()) override;
+    QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize = QSize()) override;
+    // Forwarded uncached: painting in place is the style way to avoid a pixmap by size
+    void paintTab(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon = QPixmap()) override;
+    void paintButton(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon = QPixmap()) override;
+
+    RibbonStyle* style(void) const;
+    PixmapCache* cache(void) const;
+
+    // Key of a drawTab or drawButton result in the cache (icon is a QPixmap or IconHandle cache key)
+    PixmapCache::Key makeKey(PixmapCache::Kind kind, QSize minsize, ButtonState state, const QString &name, qint64 icon, QSize maxsize);
+
+private:
+    QPixmap draw(PixmapCache::Kind kind, QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, QSize maxsize);
+    QPixmap draw(PixmapCache::Kind kind, QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize);
+
+    RibbonStyle* mStyle;
+    PixmapCache* mCache;
+    bool mOwnCache;
+    quint64 mStyleRevision;
+};
+
+}
+
+}
@@ -1,24 +1,80 @@
 #pragma once
 
+#include <RibbonStyle/NineSlice.hh>
 #include <RibbonStyle/RibbonStyle.hh>
 
 #include <QColor>
 
+#include <map>
+#include <tuple>
+
+class QPainter;
+
 namespace RibbonUI {
 
 namespace RibbonStyle {
 
-class FlatStyle {
+class FlatStyle : public RibbonStyle {
 public:
-    QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize());
-    QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize());
+    FlatStyle(void);
+
+    QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize()) override;
+    QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize()) override;
+    QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize = QSize()) override;
+    QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize = QSize()) override;
+
+    // Background from a nine-slice template and label and icon on top: no pixmap by size
+    void paintTab(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon = QPixmap()) override;
+    void paintButton(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon = QPixmap()) override;
+
+    bool isThreadSafe(void) const override;
+    QImage drawTabImage(QSize minsize, ButtonState state, const QString &name, const QImage &icon, QSize maxsize, qreal dpr) override;
+    QImage drawButtonImage(QSize minsize, ButtonState state, const QString &name, const QImage &icon, QSize maxsize, qreal dpr) override;
 
     void setMainColor(const QColor &color);
     QColor mainColor(void) const;
     void setHightlightColor(const QColor &color);
     QColor hightlightColor(void) const;
+
+    // Background template of a state (null for the states without background), made once by state, colour
+    // and ratio. GUI thread only.
+    NineSlice backgroundTemplate(ButtonState state, qreal dpr) const;
+    int templateCount(void) const;
+    qint64 templateBytes(void) const;
+
+private:
+    // Icon (pixmap, atlas sheet or image) and target of paintTab and paintButton
+    struct PaintContext {
+        const QPixmap* pixmap = nullptr;
+        const QImage* image = nullptr;
+        // Part of the icon to draw (the icon rect in an atlas sheet)
+        QRectF source;
+        qreal dpr = 1.0;
+        // QStaticText is not safe to share between threads: image rendering draws the cached elided text
+        bool staticText = true;
+
+        bool hasIcon(void) const;
+        void drawIcon(QPainter &p, const QRectF &target) const;
+    };
+
+    QPixmap renderTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, const QRectF &source, QSize maxsize);
+    QPixmap renderButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, const QRectF &source, QSize maxsize);
+
+    QSize tabSize(QSize minsize, const QString &name, bool icon, QSize maxsize) const;
+    QSize buttonSize(QSize minsize, const QString &name, bool icon, QSize maxsize) const;
+    void paintBackground(QPainter &p, const QRect &rect, ButtonState state) const;
+    void paintTabContent(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const PaintContext &context) const;
+    void paintButtonContent(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const PaintContext &context) const;
+
+    QColor background(ButtonState state) const;
+    QColor foreground(ButtonState state) const;
+
+    QColor mMainColor;
+    QColor mHightlightColor;
+    // By state, background colour and ratio
+    mutable std::map<std::tuple<int, QRgb, qreal>, NineSlice> mTemplates;
 };
 
 }
 
-}
\ No newline at end of file
+}
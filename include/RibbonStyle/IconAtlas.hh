@@ -0,0 +1,128 @@
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QRect>
+#include <QVector>
+
+#include <vector>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+class IconAtlas;
+
+// Icon stored in an atlas sheet. Cheap to copy, valid as long as its atlas and until the atlas is cleared:
+// a stale handle draws nothing.
+struct IconHandle {
+    const IconAtlas* atlas = nullptr;
+    int sheet = -1;
+    // Atlas generation the handle was created in (see IconAtlas::clear)
+    quint64 generation = 0;
+    // In device pixels
+    QRect rect;
+    qreal dpr = 1.0;
+    // Unique among every atlas of the process (used as cache key, like QPixmap::cacheKey)
+    qint64 key = 0;
+
+    bool isNull(void) const { return atlas == nullptr; }
+    // Not null and still in its atlas
+    bool isValid(void) const;
+    // Size in device independent pixels
+    QSize size(void) const { return rect.size() / dpr; }
+    QPixmap pixmap(void) const;
+};
+
+struct IconAtlasStats {
+    int sheets = 0;
+    int icons = 0;
+    // Pixels covered by icons and pixels of the sheets
+    qint64 usedPixels = 0;
+    qint64 totalPixels = 0;
+    qint64 bytes = 0;
+
+    double efficiency(void) const { return totalPixels > 0 ? double(usedPixels) / totalPixels : 0.0; }
+};
+
+// Packs command icons, at each size and device pixel ratio they are used, into a few large sheets
+// (skyline packing). Drawing from the sheets lets a whole ribbon paint its icons in a few calls.
+class IconAtlas {
+public:
+    explicit IconAtlas(const QSize &sheetSize = QSize(1024, 1024));
+
+    // Register icon rendered at size (device independent) and dpr. Adding the same icon again returns the
+    // same handle. Return a null handle if the icon is larger than a sheet.
+    IconHandle add(const QPixmap &icon, const QSize &size, qreal dpr = 1.0);
+
+    int sheetCount(void) const;
+    // Sheet as a pixmap, converted when icons were added since the last call. Null if index is out of range.
+    QPixmap sheet(int index) const;
+    // Whether handle was created by this atlas since the last clear
+    bool contains(const IconHandle &handle) const;
+
+    // Source rect of the handle in its sheet, in sheet pixmap coordinates
+    static QRectF sourceRect(const IconHandle &handle);
+
+    // Drop every sheet. Handles created before are stale from then on.
+    void clear(void);
+    IconAtlasStats stats(void) const;
+
+private:
+    struct Key {
+        qint64 icon;
+        QSize size;
+        qreal dpr;
+
+        bool operator==(const Key &other) const;
+    };
+    friend uint qHash(const Key &key, uint seed)
+    {
+        return qHash(key.icon, seed) ^ uint(key.size.width() * 65599 + key.size.height()) ^ uint(qRound(key.dpr * 100));
+    }
+
+    // Skyline of a sheet: top of the used area, by segments ordered on x
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Sheet {
+        QImage image;
+        std::vector<Segment> skyline;
+        mutable QPixmap pixmap;
+        mutable bool dirty;
+    };
+
+    bool pack(Sheet &sheet, const QSize &size, QPoint* pos);
+
+    QSize mSheetSize;
+    std::vector<Sheet> mSheets;
+    QHash<Key, IconHandle> mHandles;
+    qint64 mUsedPixels;
+    quint64 mGeneration;
+};
+
+// Icons to draw in one paint, flushed as one drawPixmapFragments call per sheet
+class IconBatch {
+public:
+    void add(const QRectF &target, const IconHandle &icon, qreal opacity = 1.0);
+    void flush(QPainter &painter);
+    bool isEmpty(void) const;
+
+private:
+    struct Batch {
+        const IconAtlas* atlas;
+        int sheet;
+        QVector<QPainter::PixmapFragment> fragments;
+    };
+
+    std::vector<Batch> mBatches;
+};
+
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QFont>
+#include <QHash>
+#include <QMutex>
+#include <QStaticText>
+#include <QString>
+
+#include <list>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+struct LabelCacheStats {
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+    int entries = 0;
+};
+
+// Measured and shaped label, ready to be drawn with QPainter::drawStaticText
+struct Label {
+    // Advance of the whole text
+    int width = 0;
+    int height = 0;
+    // Text elided to the maximal width, its advance and its shaped version
+    QString elided;
+    int elidedWidth = 0;
+    QStaticText text;
+    // Whether text is prepared. Only done for lookups from the GUI thread: shaping elsewhere would tie the
+    // glyphs to the font engines of another thread.
+    bool prepared = false;
+};
+
+// LRU cache of label measurement and shaping, bounded by a number of entries. Entries are keyed on font,
+// text, maximal width and device pixel ratio; the shared cache is cleared when the application font changes.
+class LabelCache {
+public:
+    explicit LabelCache(int capacity = 4096);
+
+    // Cache used by the styles. Lookups are thread safe; off the GUI thread they only measure and elide (the
+    // QStaticText of the label is not prepared and must not be drawn).
+    static LabelCache &shared(void);
+    // Clear the shared cache on application font change. Done when the QCoreApplication is constructed; call
+    // it from the GUI thread if the library is loaded after. Does nothing from another thread.
+    static void watchFontChanges(void);
+
+    void setCapacity(int entries);
+    int capacity(void) const;
+
+    // maxwidth < 0 means no eliding
+    Label label(const QFont &font, const QString &text, int maxwidth = -1, qreal dpr = 1.0);
+
+    void clear(void);
+
+    LabelCacheStats stats(void) const;
+    void resetStats(void);
+
+    struct Key {
+        QFont font;
+        QString text;
+        int maxwidth;
+        qreal dpr;
+
+        bool operator==(const Key &other) const;
+    };
+
+private:
+    struct Entry {
+        Key key;
+        Label label;
+    };
+
+    static Label measure(const Key &key);
+    static void prepare(const Key &key, Label* label);
+    void trim(int capacity);
+
+    std::list<Entry> mEntries;
+    QHash<Key, std::list<Entry>::iterator> mIndex;
+    int mCapacity;
+    LabelCacheStats mStats;
+    mutable QMutex mMutex;
+};
+
+uint qHash(const LabelCache::Key &key, uint seed = 0);
+
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QMargins>
+#include <QPixmap>
+#include <QRect>
+
+class QPainter;
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+// Background template drawn at any size: the corners are copied, the edges and the centre are stretched.
+// The margins are in device independent pixels, the pixmap carries its device pixel ratio.
+class NineSlice {
+public:
+    NineSlice(void) = default;
+    NineSlice(const QPixmap &pixmap, const QMargins &margins);
+
+    bool isNull(void) const;
+    QPixmap pixmap(void) const;
+    QMargins margins(void) const;
+    // Smallest size drawn without overlapping corners
+    QSize minimumSize(void) const;
+
+    void draw(QPainter &p, const QRect &target) const;
+
+private:
+    QPixmap mPixmap;
+    QMargins mMargins;
+};
+
+}
+
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <RibbonStyle/LabelCache.hh>
+#include <RibbonStyle/RibbonStyle.hh>
+
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPainterPath>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+// Compile-time styles: a policy is a struct of constexpr tables (palette by ButtonState, metrics, corner
+// radii) and PolicyRenderer<Policy> draws with it. Everything the policy fixes is folded by the compiler,
+// so renderers that know their style statically skip virtual dispatch and runtime lookups.
+// PolicyStyle<Policy> adapts a policy to the RibbonStyle interface.
+//
+// A policy provides:
+//   static constexpr QRgb Background[4], Foreground[4]   by ButtonState, a transparent background isn't filled
+//   static constexpr int TabPadding, TabIconSize, ButtonPadding, ButtonIconSize, Spacing
+//   static constexpr int TabRadius, ButtonRadius          0 for square corners
+
+// Same rendering as FlatStyle with its default colors
+struct FlatPolicy {
+    static constexpr QRgb Background[4] = {0x00000000, 0xff3e6db5, 0xff2b579a, 0x00000000};
+    static constexpr QRgb Foreground[4] = {0xff2b579a, 0xffffffff, 0xffffffff, 0xffa0a0a4};
+
+    static constexpr int TabPadding = 12;
+    static constexpr int TabIconSize = 16;
+    static constexpr int ButtonPadding = 4;
+    static constexpr int ButtonIconSize = 32;
+    static constexpr int Spacing = 4;
+
+    static constexpr int TabRadius = 0;
+    static constexpr int ButtonRadius = 0;
+};
+
+template <typename Policy>
+class PolicyRenderer {
+public:
+    static QSize tabSize(QSize minsize, const QString &name, bool icon, QSize maxsize)
+    {
+        Label label = LabelCache::shared().label(QGuiApplication::font(), name);
+        int width = 2 * Policy::TabPadding + label.width;
+        int height = label.height + 2 * Policy::Spacing;
+
+        if (icon) {
+            width += Policy::TabIconSize + Policy::Spacing;
+            height = qMax(height, Policy::TabIconSize + 2 * Policy::Spacing);
+        }
+        return bound(QSize(width, height), minsize, maxsize);
+    }
+
+    static QSize buttonSize(QSize minsize, const QString &name, bool icon, QSize maxsize)
+    {
+        Label label = LabelCache::shared().label(QGuiApplication::font(), name);
+        int width = 2 * Policy::ButtonPadding + label.width;
+        int height = 2 * Policy::ButtonPadding + label.height;
+
+        if (icon) {
+            width = qMax(width, 2 * Policy::ButtonPadding + Policy::ButtonIconSize);
+            height += Policy::ButtonIconSize + Policy::Spacing;
+        }
+        return bound(QSize(width, height), minsize, maxsize);
+    }
+
+    static void paintTab(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon, qreal dpr)
+    {
+        fill<Policy::TabRadius>(p, rect, state);
+
+        QRect content = rect.adjusted(Policy::TabPadding, 0, -Policy::TabPadding, 0);
+        if (!icon.isNull()) {
+            QRect iconRect(content.left(), content.top() + (content.height() - Policy::TabIconSize) / 2,
+                           Policy::TabIconSize, Policy::TabIconSize);
+            p.drawPixmap(iconRect, icon);
+            content.setLeft(iconRect.right() + 1 + Policy::Spacing);
+        }
+
+        Label label = LabelCache::shared().label(QGuiApplication::font(), name, content.width(), dpr);
+        p.setFont(QGuiApplication::font());
+        p.setPen(QColor(Policy::Foreground[state]));
+        QPoint pos(content.left(), content.top() + (content.height() - label.height) / 2);
+        if (label.prepared)
+            p.drawStaticText(pos, label.text);
+        else
+            p.drawText(QRect(pos, QSize(label.elidedWidth, label.height)), Qt::AlignLeft | Qt::AlignTop, label.elided);
+    }
+
+    static void paintButton(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon, qreal dpr)
+    {
+        fill<Policy::ButtonRadius>(p, rect, state);
+
+        QRect content = rect.adjusted(Policy::ButtonPadding, Policy::ButtonPadding, -Policy::ButtonPadding, -Policy::ButtonPadding);
+        if (!icon.isNull()) {
+            QRect iconRect(content.left() + (content.width() - Policy::ButtonIconSize) / 2, content.top(),
+                           Policy::ButtonIconSize, Policy::ButtonIconSize);
+            p.drawPixmap(iconRect, icon);
+            content.setTop(iconRect.bottom() + 1 + Policy::Spacing);
+        }
+
+        Label label = LabelCache::shared().label(QGuiApplication::font(), name, content.width(), dpr);
+        p.setFont(QGuiApplication::font());
+        p.setPen(QColor(Policy::Foreground[state]));
+        QPoint pos(content.left() + (content.width() - label.elidedWidth) / 2, content.top());
+        if (label.prepared)
+            p.drawStaticText(pos, label.text);
+        else
+            p.drawText(QRect(pos, QSize(label.elidedWidth, label.height)), Qt::AlignLeft | Qt::AlignTop, label.elided);
+    }
+
+    static QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, QSize maxsize, qreal dpr)
+    {
+        QSize size = tabSize(minsize, name, !icon.isNull(), maxsize);
+        QPixmap ret = surface(size, dpr);
+        QPainter p(&ret);
+        paintTab(p, QRect(QPoint(0, 0), size), state, name, icon, dpr);
+        return ret;
+    }
+
+    static QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, QSize maxsize, qreal dpr)
+    {
+        QSize size = buttonSize(minsize, name, !icon.isNull(), maxsize);
+        QPixmap ret = surface(size, dpr);
+        QPainter p(&ret);
+        paintButton(p, QRect(QPoint(0, 0), size), state, name, icon, dpr);
+        return ret;
+    }
+
+private:
+    static QSize bound(QSize size, QSize minsize, QSize maxsize)
+    {
+        size = size.expandedTo(minsize);
+        if (maxsize.isValid())
+            size = size.boundedTo(maxsize);
+        return size;
+    }
+
+    static QPixmap surface(QSize size, qreal dpr)
+    {
+        QPixmap ret(size * dpr);
+        ret.setDevicePixelRatio(dpr);
+        ret.fill(Qt::transparent);
+        return ret;
+    }
+
+    template <int Radius>
+    static void fill(QPainter &p, const QRect &rect, ButtonState state)
+    {
+        QRgb back = Policy::Background[state];
+        if (qAlpha(back) == 0)
+            return;
+
+        if constexpr (Radius == 0) {
+            p.fillRect(rect, QColor::fromRgba(back));
+        }
+        else {
+            QPainterPath path;
+            path.addRoundedRect(QRectF(rect), Radius, Radius);
+            p.save();
+            p.setRenderHint(QPainter::Antialiasing);
+            p.fillPath(path, QColor::fromRgba(back));
+            p.restore();
+        }
+    }
+};
+
+// RibbonStyle interface over a policy, for code holding styles at runtime (plugins, CachedStyle...)
+template <typename Policy>
+class PolicyStyle : public RibbonStyle {
+public:
+    QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize()) override
+    {
+        return PolicyRenderer<Policy>::drawTab(minsize, state, name, icon, maxsize, devicePixelRatio());
+    }
+
+    QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize()) override
+    {
+        return PolicyRenderer<Policy>::drawButton(minsize, state, name, icon, maxsize, devicePixelRatio());
+    }
+
+    using RibbonStyle::drawTab;
+    using RibbonStyle::drawButton;
+};
+
+}
+
+}
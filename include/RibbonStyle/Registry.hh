@@ -0,0 +1,79 @@
+#pragma once
+
+#include <RibbonStyle/Cache.hh>
+
+#include <QString>
+
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+// Memory held by the cached pixmaps of registry styles. Shared styles are used by several windows, unique
+// styles by one. For a window, attributedBytes counts the unique bytes and its part of the shared bytes.
+struct StyleMemoryReport {
+    int styles = 0;
+    qint64 sharedBytes = 0;
+    qint64 uniqueBytes = 0;
+    qint64 attributedBytes = 0;
+    qint64 budget = 0;
+};
+
+// Process wide set of styles, one instance by identifier whatever the number of windows using it. Every
+// style draws through a CachedStyle backed by a single cache, so that all windows share the pixmaps and one
+// byte budget. A style is created on its first acquisition and destroyed (with its pixmaps) when the last
+// window releases it. The styles and pixmaps left are dropped with the QCoreApplication (pixmaps can't
+// outlive it). GUI thread only.
+class StyleRegistry {
+public:
+    typedef std::function<RibbonStyle*(void)> Factory;
+
+    static StyleRegistry &shared(void);
+
+    // "flat" (FlatStyle) is registered by default. Replacing a factory does not affect living styles.
+    void registerFactory(const QString &id, const Factory &factory);
+    bool hasFactory(const QString &id) const;
+
+    // Style for the window, counted once by call. Return null for an unknown identifier.
+    CachedStyle* acquire(const QString &id, const void* window);
+    void release(const QString &id, const void* window);
+    // Release every style acquired by the window (to call when the window is destroyed)
+    void releaseAll(const void* window);
+
+    // Number of windows using the style, and acquisitions of the window
+    int users(const QString &id) const;
+    int references(const QString &id, const void* window) const;
+
+    void setBudget(qint64 bytes);
+    qint64 budget(void) const;
+    PixmapCache &cache(void);
+
+    StyleMemoryReport report(void) const;
+    StyleMemoryReport report(const void* window) const;
+
+private:
+    StyleRegistry(void);
+
+    struct Entry {
+        std::unique_ptr<RibbonStyle> style;
+        std::unique_ptr<CachedStyle> cached;
+        // Acquisitions by window
+        std::map<const void*, int> windows;
+    };
+
+    void destroy(std::map<QString, Entry>::iterator it);
+    // Post routine of the application
+    static void cleanup(void);
+
+    std::map<QString, Factory> mFactories;
+    std::map<QString, Entry> mStyles;
+    PixmapCache mCache;
+    bool mCleanupRegistered;
+};
+
+}
+
+}
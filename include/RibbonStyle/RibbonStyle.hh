@@ -1,5 +1,9 @@
 #pragma once
 
+#include <RibbonStyle/IconAtlas.hh>
+
+#include <QImage>
+#include <QPainter>
 #include <QPixmap>
 #include <QSize>
 #include <QString>
@@ -17,12 +21,61 @@ enum ButtonState {
 
 class RibbonStyle {
 public:
+    virtual ~RibbonStyle() = default;
+
     virtual QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize()) = 0;
     virtual QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon = QPixmap(), QSize maxsize = QSize()) = 0;
 
+    // Same with an icon from an IconAtlas. The default implementation draws a copy of the icon.
+    virtual QPixmap drawTab(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize = QSize())
+    {
+        return drawTab(minsize, state, name, icon.pixmap(), maxsize);
+    }
+    virtual QPixmap drawButton(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize = QSize())
+    {
+        return drawButton(minsize, state, name, icon.pixmap(), maxsize);
+    }
+
+    // Paint straight into rect, at the ratio of the painter device. The default implementation blits the
+    // drawTab or drawButton result; styles can avoid the intermediate pixmap of each size.
+    virtual void paintTab(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon = QPixmap())
+    {
+        p.drawPixmap(rect.topLeft(), drawTab(rect.size(), state, name, icon, rect.size()));
+    }
+    virtual void paintButton(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon = QPixmap())
+    {
+        p.drawPixmap(rect.topLeft(), drawButton(rect.size(), state, name, icon, rect.size()));
+    }
+
+    // Rendering to QImage at the given ratio. Styles returning true from isThreadSafe() can do it from any
+    // thread (while the style isn't modified); the default implementation is for the GUI thread only.
+    virtual bool isThreadSafe(void) const { return false; }
+    virtual QImage drawTabImage(QSize minsize, ButtonState state, const QString &name, const QImage &icon, QSize maxsize, qreal dpr)
+    {
+        setDevicePixelRatio(dpr);
+        return drawTab(minsize, state, name, QPixmap::fromImage(icon), maxsize).toImage();
+    }
+    virtual QImage drawButtonImage(QSize minsize, ButtonState state, const QString &name, const QImage &icon, QSize maxsize, qreal dpr)
+    {
+        setDevicePixelRatio(dpr);
+        return drawButton(minsize, state, name, QPixmap::fromImage(icon), maxsize).toImage();
+    }
 
+    // Device pixel ratio of the generated pixmaps
+    void setDevicePixelRatio(qreal ratio) { mDevicePixelRatio = ratio > 0.0 ? ratio : 1.0; }
+    qreal devicePixelRatio(void) const { return mDevicePixelRatio; }
+
+    // Incremented each time a parameter changing the style output is modified (used by caches)
+    quint64 revision(void) const { return mRevision; }
+
+protected:
+    void invalidate(void) { ++mRevision; }
+
+private:
+    qreal mDevicePixelRatio = 1.0;
+    quint64 mRevision = 0;
 };
 
 }
 
-}
\ No newline at end of file
+}
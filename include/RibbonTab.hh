@@ -0,0 +1,166 @@
+#pragma once
+
+#include <RibbonStyle/RibbonStyle.hh>
+
+#include <QPixmap>
+#include <QRect>
+#include <QString>
+
+#include <unordered_map>
+#include <vector>
+
+namespace RibbonUI {
+
+enum ControlSize {
+    LargeControl,
+    MediumControl,
+    SmallControl
+};
+
+// Reductions of a group when the tab gets narrow, the order matters
+enum GroupVariant {
+    GroupLarge,
+    GroupMedium,
+    GroupSmall,
+    GroupCollapsed,
+    GroupVariantCount
+};
+
+typedef int GroupId;
+typedef int ControlId;
+// Index of a command in a CommandStateStore, -1 for none
+typedef int CommandId;
+
+// Retained model of a ribbon tab. Groups and controls are plain structs kept in contiguous arrays
+// (controls sorted by group) and laid out without any widget. Changing a control only marks its group
+// dirty: layout() measures the dirty controls again and shifts the following groups.
+//
+// Every variant of every group is measured by layout(), which then builds a table of the tab width at
+// each reduction step (groups reduced one level at a time, from the right). Resizing is then a binary
+// search in that table and does no measurement.
+class Tab {
+public:
+    // Height of the control area of a group, and minimal height of a row of medium or small controls
+    static const int ControlsHeight = 66;
+    static const int RowHeight = 22;
+    static const int GroupPadding = 4;
+    static const int GroupTitleHeight = 18;
+
+    // Style call drawing a control of the given size: drawButton or drawTab, its minsize, and whether the
+    // label is drawn
+    struct ControlRender {
+        bool button;
+        QSize minsize;
+        bool label;
+    };
+    static ControlRender controlRender(ControlSize size);
+
+    explicit Tab(const QString &name = QString());
+
+    void setName(const QString &name);
+    QString name(void) const;
+
+    GroupId addGroup(const QString &title);
+    ControlId addControl(GroupId group, const QString &label, const QPixmap &icon = QPixmap(), ControlSize size = LargeControl);
+
+    void setGroupTitle(GroupId group, const QString &title);
+    QString groupTitle(GroupId group) const;
+
+    void setLabel(ControlId control, const QString &label);
+    QString label(ControlId control) const;
+    void setIcon(ControlId control, const QPixmap &icon);
+    QPixmap icon(ControlId control) const;
+    void setSize(ControlId control, ControlSize size);
+    ControlSize size(ControlId control) const;
+    void setVisible(ControlId control, bool visible);
+    bool isVisible(ControlId control) const;
+    // State the control is drawn with. Doesn't affect the layout; return true if it changed.
+    bool setState(ControlId control, RibbonStyle::ButtonState state);
+    RibbonStyle::ButtonState state(ControlId control) const;
+    // Command whose state the control displays
+    void setCommand(ControlId control, CommandId command);
+    CommandId command(ControlId control) const;
+    // Controls bound to a command
+    const std::vector<ControlId> &commandControls(CommandId command) const;
+
+    GroupId group(ControlId control) const;
+    // Size the control is displayed at in the current reduction step
+    ControlSize displayedSize(ControlId control) const;
+    int groupCount(void) const;
+    int controlCount(void) const;
+
+    // Lay out the dirty groups, return true if anything was laid out again
+    bool layout(RibbonStyle::RibbonStyle &style);
+    bool needsLayout(void) const;
+    // Mark everything dirty (style, font or DPI change)
+    void invalidate(void);
+
+    // Pick the largest reduction step fitting in width, return true if a group changed variant.
+    // Cheap as long as the tab doesn't need a layout.
+    bool setAvailableWidth(int width);
+    int availableWidth(void) const;
+    GroupVariant groupVariant(GroupId group) const;
+    // Tab width at each reduction step, in decreasing order
+    const std::vector<int> &breakpoints(void) const;
+
+    // Geometries in tab coordinates, valid after layout(). Controls of a collapsed group have no geometry.
+    QRect groupGeometry(GroupId group) const;
+    QRect controlGeometry(ControlId control) const;
+    QSize sizeHint(void) const;
+
+    // Number of controls measured by the last layout() call
+    int measuredControls(void) const;
+
+private:
+    struct Control {
+        ControlId id;
+        GroupId group;
+        QString label;
+        QPixmap icon;
+        ControlSize size;
+        bool visible;
+        bool dirty;
+        RibbonStyle::ButtonState state;
+        CommandId command;
+        // By ControlSize, only sizes from size to SmallControl are measured
+        QSize measured[GroupCollapsed];
+        // By GroupVariant, relative to the group
+        QRect geometry[GroupCollapsed];
+    };
+
+    struct Group {
+        QString title;
+        int first;
+        int count;
+        bool dirty;
+        int x;
+        int width[GroupVariantCount];
+        // Variant used at each reduction level (a variant not narrower than the previous one is skipped)
+        GroupVariant variants[GroupVariantCount];
+        int level;
+    };
+
+    Control &control(ControlId id);
+    const Control &control(ControlId id) const;
+    void markDirty(ControlId id);
+
+    QSize measure(RibbonStyle::RibbonStyle &style, const Control &control, ControlSize size) const;
+    void layoutGroup(RibbonStyle::RibbonStyle &style, Group &group);
+    void updateBreakpoints(void);
+    int findStep(void) const;
+    bool applyStep(int step);
+
+    QString mName;
+    std::vector<Group> mGroups;
+    std::vector<Control> mControls;
+    // Index in mControls of each control id
+    std::vector<int> mControlIndex;
+    std::vector<int> mBreakpoints;
+    std::unordered_map<CommandId, std::vector<ControlId>> mCommandControls;
+    bool mDirty;
+    int mAvailableWidth;
+    int mStep;
+    int mMeasured;
+};
+
+}
@@ -1,12 +1,110 @@
 #pragma once
 
+#include <CommandState.hh>
 #include <CustomWindow.hh>
+#include <RibbonTab.hh>
+#include <RibbonStyle/AsyncRenderer.hh>
+#include <RibbonStyle/Registry.hh>
+
+#include <QTimer>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
 
 namespace RibbonUI {
 
+// Fills a new tab page with its groups and controls
+typedef std::function<void(Tab& tab)> TabBuilder;
+
+struct TabPageStats {
+	int registered = 0;
+	int materialized = 0;
+	quint64 materializations = 0;
+	quint64 dematerializations = 0;
+	// Time spent building, laying out and queuing the pre-rendering of pages
+	qint64 buildNs = 0;
+};
+
 class Window : public CustomWindow::CustomWindow {
 public:
 	Window(QWidget* parent, Qt::WindowFlags flags);
+	~Window();
+
+	// Style shared with the other windows through the StyleRegistry ("flat" by default)
+	bool setRibbonStyle(const QString& id);
+	QString ribbonStyleId(void) const;
+	RibbonStyle::CachedStyle* ribbonStyle(void) const;
+
+	RibbonStyle::StyleMemoryReport styleMemory(void) const;
+
+	// Register a tab page. Nothing is built until the page is activated or prefetched: the builder fills
+	// the controls, then the page is laid out and its pixmaps are rendered in background.
+	int addTab(const QString& title, const TabBuilder& builder);
+	int tabCount(void) const;
+	QString tabTitle(int index) const;
+
+	void setCurrentTab(int index);
+	int currentTab(void) const;
+	// Page likely to be activated soon (hovered tab header...): built once the window has painted its first
+	// frame, one prefetched page per timer tick
+	void prefetchTab(int index);
+
+	bool isMaterialized(int index) const;
+	// Null if the page isn't built
+	Tab* tab(int index) const;
+
+	// Maximal number of built pages, the least recently used idle pages are released beyond (0: no limit)
+	void setMaterializedLimit(int count);
+	int materializedLimit(void) const;
+	// Release every built page but the current one (memory pressure). Return the number of released pages.
+	int releaseIdleTabs(void);
+
+	TabPageStats tabStats(void) const;
+
+	// Command states displayed by the controls bound to commands (Tab::setCommand). Workers update the store,
+	// the window applies the changes once per event loop iteration. The store may be updated meanwhile; it
+	// must outlive the window or be unset first. Return false if another window consumes the store.
+	bool setCommandStore(CommandStateStore* store);
+	CommandStateStore* commandStore(void) const;
+	// Apply the pending changes now, return the number of changed commands
+	int syncCommandStates(void);
+
+protected:
+	void resizeEvent(QResizeEvent* eve);
+	bool event(QEvent* eve);
+
+private:
+	struct TabPage {
+		QString title;
+		TabBuilder builder;
+		std::unique_ptr<Tab> tab;
+		quint64 lastUse = 0;
+	};
+
+	Tab* materialize(int index);
+	void applyCommandStates(Tab& tab);
+	void dematerialize(int index);
+	void enforceLimit(void);
+	void prefetchNext(void);
+
+	QString mStyleId;
+	RibbonStyle::CachedStyle* mStyle = nullptr;
+	std::unique_ptr<RibbonStyle::AsyncRenderer> mRenderer;
+
+	std::vector<TabPage> mPages;
+	int mCurrent = -1;
+	int mLimit = 0;
+	quint64 mUseClock = 0;
+	TabPageStats mStats;
+
+	std::deque<int> mPrefetch;
+	QTimer mPrefetchTimer;
+	bool mPainted = false;
+
+	CommandStateStore* mCommandStore = nullptr;
+	std::vector<CommandChange> mCommandChanges;
 };
 
-}
\ No newline at end of file
+}
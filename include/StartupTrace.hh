@@ -0,0 +1,79 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef StartupTrace_HH_
+#define StartupTrace_HH_
+
+#include <QJsonObject>
+#include <QString>
+
+// Startup phases, recorded when RIBBON_INSTRUMENTATION is defined (CMake option) and tracing is enabled.
+// Names must be string literals: only the pointer is stored.
+#ifdef RIBBON_INSTRUMENTATION
+	#define STARTUP_CONCAT_(a, b) a##b
+	#define STARTUP_CONCAT(a, b) STARTUP_CONCAT_(a, b)
+	#define STARTUP_SCOPE(name) ::CustomWindow::StartupTrace::Scope STARTUP_CONCAT(startupScope, __LINE__)(name)
+	#define STARTUP_MARK(name) ::CustomWindow::StartupTrace::mark(name)
+	#define STARTUP_FIRST_PAINT() ::CustomWindow::StartupTrace::firstPaintDone()
+#else
+	#define STARTUP_SCOPE(name) do {} while (0)
+	#define STARTUP_MARK(name) do {} while (0)
+	#define STARTUP_FIRST_PAINT() do {} while (0)
+#endif
+
+namespace CustomWindow {
+
+// Timestamps of the startup phases, up to the end of the first paint of a window, in a fixed size ring
+// buffer (the oldest events are overwritten). Time zero is the process creation.
+//
+// Tracing is enabled by the RIBBON_STARTUP_TRACE environment variable, or enable(), naming the file which
+// receives the Chrome trace-event JSON (chrome://tracing, Perfetto) when the application exits.
+class StartupTrace {
+public:
+	static const int Capacity = 1024;
+
+	static void enable(const QString& file);
+	static bool isEnabled(void);
+	// True until the first paint of a window ended, recording stops then
+	static bool isRecording(void);
+
+	// Nanoseconds since the process creation
+	static qint64 now(void);
+
+	static void mark(const char* name);
+	static void complete(const char* name, qint64 start, qint64 duration);
+	// End of the first paint: marks it and stops recording
+	static void firstPaintDone(void);
+
+	// {"traceEvents": [...]} with the events still in the buffer, oldest first
+	static QJsonObject toJson(void);
+	static bool write(const QString& file);
+
+	// Record the enclosing block as a complete event
+	class Scope {
+	public:
+		explicit Scope(const char* name);
+		~Scope();
+
+	private:
+		const char* mName;
+		qint64 mStart;
+	};
+};
+
+}
+
+#endif
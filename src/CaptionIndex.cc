@@ -0,0 +1,93 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "CaptionIndex.hh"
+
+#include <algorithm>
+
+namespace CustomWindow {
+
+void CaptionIndex::build(const std::vector<QRect>& rects)
+{
+	clear();
+
+	std::vector<int> edges;
+	edges.reserve(2 * rects.size());
+	for (const QRect& r : rects) {
+		edges.push_back(r.y());
+		edges.push_back(r.y() + r.height() + 1);
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+	std::vector<std::pair<int, int>> row;
+	for (size_t i = 0; i + 1 < edges.size(); i++) {
+		int top = edges[i];
+
+		row.clear();
+		for (const QRect& r : rects) {
+			if (r.y() <= top && top <= r.y() + r.height())
+				row.emplace_back(r.x(), r.x() + r.width());
+		}
+		std::sort(row.begin(), row.end());
+
+		mSlabTop.push_back(top);
+		mSlabFirst.push_back(static_cast<int>(mIntervals.size()));
+		for (const auto& interval : row) {
+			if (mIntervals.size() > static_cast<size_t>(mSlabFirst.back()) && interval.first <= mIntervals.back().second + 1)
+				mIntervals.back().second = std::max(mIntervals.back().second, interval.second);
+			else
+				mIntervals.push_back(interval);
+		}
+	}
+
+	// Sentinel slab closing the last one
+	if (!edges.empty()) {
+		mSlabTop.push_back(edges.back());
+		mSlabFirst.push_back(static_cast<int>(mIntervals.size()));
+	}
+}
+
+void CaptionIndex::clear(void)
+{
+	mSlabTop.clear();
+	mSlabFirst.clear();
+	mIntervals.clear();
+}
+
+bool CaptionIndex::contains(int x, int y) const
+{
+	auto slab = std::upper_bound(mSlabTop.begin(), mSlabTop.end(), y);
+	if (slab == mSlabTop.begin() || slab == mSlabTop.end())
+		return false;
+
+	size_t i = static_cast<size_t>(slab - mSlabTop.begin()) - 1;
+	auto first = mIntervals.begin() + mSlabFirst[i];
+	auto last = mIntervals.begin() + mSlabFirst[i + 1];
+
+	auto interval = std::upper_bound(first, last, x, [](int v, const std::pair<int, int>& iv) { return v < iv.first; });
+	if (interval == first)
+		return false;
+	--interval;
+	return x <= interval->second;
+}
+
+bool CaptionIndex::isEmpty(void) const
+{
+	return mIntervals.empty();
+}
+
+}
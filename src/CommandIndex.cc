@@ -0,0 +1,272 @@
+#include <CommandIndex.hh>
+#include <RibbonDefinition.hh>
+
+#include <algorithm>
+
+namespace RibbonUI {
+
+// Scores of a query word, the best match of the command is taken
+static const int WholeWordScore = 100;
+static const int WordStartScore = 60;
+static const int InsideWordScore = 20;
+static const int FirstWordBonus = 20;
+
+CommandIndex::CommandIndex(void)
+{
+}
+
+void CommandIndex::addCommand(CommandId command, const QString &label, const QStringList &keywords)
+{
+    removeCommand(command);
+
+    int slot;
+    if (mFree.empty()) {
+        slot = int(mEntries.size());
+        mEntries.push_back(Entry());
+    }
+    else {
+        slot = mFree.back();
+        mFree.pop_back();
+    }
+
+    Entry &entry = mEntries[slot];
+    entry.command = command;
+    entry.label = label;
+    entry.words = split(normalize(label));
+    entry.keywordWords = int(entry.words.size());
+    for (const QString &keyword : keywords) {
+        for (QString &word : split(normalize(keyword)))
+            entry.words.push_back(std::move(word));
+    }
+    entry.used = true;
+
+    entry.keys.clear();
+    for (const QString &word : entry.words)
+        addKeys(word, &entry.keys);
+    std::sort(entry.keys.begin(), entry.keys.end());
+    entry.keys.erase(std::unique(entry.keys.begin(), entry.keys.end()), entry.keys.end());
+
+    // Reused slots land anywhere in the lists, which stay sorted
+    for (quint64 k : entry.keys) {
+        std::vector<int> &postings = mPostings[k];
+        postings.insert(std::lower_bound(postings.begin(), postings.end(), slot), slot);
+    }
+    mSlots[command] = slot;
+}
+
+void CommandIndex::removeCommand(CommandId command)
+{
+    auto it = mSlots.find(command);
+    if (it == mSlots.end())
+        return;
+
+    int slot = it->second;
+    Entry &entry = mEntries[slot];
+    for (quint64 k : entry.keys) {
+        auto postings = mPostings.find(k);
+        std::vector<int> &list = postings->second;
+        list.erase(std::lower_bound(list.begin(), list.end(), slot));
+        if (list.empty())
+            mPostings.erase(postings);
+    }
+
+    entry = Entry();
+    entry.used = false;
+    mFree.push_back(slot);
+    mSlots.erase(it);
+}
+
+bool CommandIndex::contains(CommandId command) const
+{
+    return mSlots.count(command) != 0;
+}
+
+QString CommandIndex::label(CommandId command) const
+{
+    auto it = mSlots.find(command);
+    return it == mSlots.end() ? QString() : mEntries[it->second].label;
+}
+
+int CommandIndex::size(void) const
+{
+    return int(mSlots.size());
+}
+
+void CommandIndex::clear(void)
+{
+    mEntries.clear();
+    mFree.clear();
+    mSlots.clear();
+    mPostings.clear();
+}
+
+void CommandIndex::addCommands(const RibbonDefinition &definition)
+{
+    for (int c = 0; c < definition.commandCount(); c++)
+        addCommand(CommandId(c), definition.commandLabel(c));
+}
+
+void CommandIndex::addCommands(const Tab &tab)
+{
+    for (ControlId control = 0; control < tab.controlCount(); control++) {
+        if (tab.command(control) >= 0)
+            addCommand(tab.command(control), tab.label(control));
+    }
+}
+
+void CommandIndex::removeCommands(const Tab &tab)
+{
+    for (ControlId control = 0; control < tab.controlCount(); control++) {
+        if (tab.command(control) >= 0)
+            removeCommand(tab.command(control));
+    }
+}
+
+std::vector<SearchHit> CommandIndex::search(const QString &query, int limit) const
+{
+    std::vector<SearchHit> hits;
+    const std::vector<QString> words = split(normalize(query));
+    if (words.empty() || limit <= 0)
+        return hits;
+
+    // Posting lists of every query word: its trigrams, or its prefix when shorter
+    std::vector<const std::vector<int>*> lists;
+    for (const QString &word : words) {
+        std::vector<quint64> keys;
+        if (word.size() < 3)
+            keys.push_back(key(word.constData(), word.size()));
+        else
+            addTrigrams(word, &keys);
+
+        for (quint64 k : keys) {
+            auto it = mPostings.find(k);
+            if (it == mPostings.end())
+                return hits;
+            lists.push_back(&it->second);
+        }
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const std::vector<int>* a, const std::vector<int>* b) {
+        return a->size() < b->size();
+    });
+
+    // Intersect, from the shortest list, by binary search in the longer ones
+    std::vector<int> candidates = *lists[0];
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+        const std::vector<int> &list = *lists[i];
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&list](int slot) {
+            return !std::binary_search(list.begin(), list.end(), slot);
+        }), candidates.end());
+    }
+
+    // Trigrams only filter: every word must really match
+    for (int slot : candidates) {
+        const Entry &entry = mEntries[slot];
+        int score = 0;
+        for (const QString &word : words) {
+            int s = matchScore(entry, word);
+            if (s == 0) {
+                score = 0;
+                break;
+            }
+            score += s;
+        }
+        if (score > 0)
+            hits.push_back({entry.command, score});
+    }
+
+    auto better = [this](const SearchHit &a, const SearchHit &b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        int la = mEntries[mSlots.at(a.command)].label.size();
+        int lb = mEntries[mSlots.at(b.command)].label.size();
+        if (la != lb)
+            return la < lb;
+        return a.command < b.command;
+    };
+    if (int(hits.size()) > limit) {
+        std::partial_sort(hits.begin(), hits.begin() + limit, hits.end(), better);
+        hits.resize(size_t(limit));
+    }
+    else {
+        std::sort(hits.begin(), hits.end(), better);
+    }
+    return hits;
+}
+
+QString CommandIndex::normalize(const QString &text)
+{
+    // Decomposed, so that diacritics are separate marks to drop
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD).toCaseFolded();
+    QString ret;
+    ret.reserve(decomposed.size());
+    for (QChar ch : decomposed) {
+        if (ch.category() == QChar::Mark_NonSpacing || ch == QLatin1Char('&'))
+            continue;
+        ret.append(ch.isLetterOrNumber() ? ch : QChar(' '));
+    }
+    return ret;
+}
+
+std::vector<QString> CommandIndex::split(const QString &text)
+{
+    std::vector<QString> ret;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    const QStringList words = text.split(QChar(' '), Qt::SkipEmptyParts);
+#else
+    const QStringList words = text.split(QChar(' '), QString::SkipEmptyParts);
+#endif
+    for (const QString &word : words)
+        ret.push_back(word);
+    return ret;
+}
+
+void CommandIndex::addKeys(const QString &word, std::vector<quint64>* keys)
+{
+    keys->push_back(key(word.constData(), 1));
+    if (word.size() >= 2)
+        keys->push_back(key(word.constData(), 2));
+    addTrigrams(word, keys);
+}
+
+void CommandIndex::addTrigrams(const QString &word, std::vector<quint64>* keys)
+{
+    for (int i = 0; i + 3 <= word.size(); i++)
+        keys->push_back(key(word.constData() + i, 3));
+}
+
+quint64 CommandIndex::key(const QChar* chars, int length)
+{
+    // Length in the high bits: prefixes and trigrams never collide
+    quint64 ret = quint64(length) << 48;
+    for (int i = 0; i < length; i++)
+        ret |= quint64(chars[i].unicode()) << (16 * (length - 1 - i));
+    return ret;
+}
+
+int CommandIndex::matchScore(const Entry &entry, const QString &word) const
+{
+    int best = 0;
+    for (int i = 0; i < int(entry.words.size()); i++) {
+        const QString &candidate = entry.words[i];
+        int score = 0;
+        if (candidate == word)
+            score = WholeWordScore;
+        else if (candidate.startsWith(word))
+            score = WordStartScore;
+        else if (word.size() >= 3 && candidate.contains(word))
+            score = InsideWordScore;
+        else
+            continue;
+
+        if (i == 0)
+            score += FirstWordBonus;
+        // Keywords count half
+        if (i >= entry.keywordWords)
+            score /= 2;
+        best = std::max(best, score);
+    }
+    return best;
+}
+
+}
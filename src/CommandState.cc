@@ -0,0 +1,163 @@
+#include <CommandState.hh>
+
+#include <algorithm>
+
+namespace RibbonUI {
+
+// Word layout: bit 0 disabled (so that 0 is the default state), bit 1 checked, bits 16 to 31 badge
+static const quint32 DisabledBit = 1u << 0;
+static const quint32 CheckedBit = 1u << 1;
+static const int BadgeShift = 16;
+static const quint32 BadgeMask = 0xffffu << BadgeShift;
+
+RibbonStyle::ButtonState CommandState::buttonState(void) const
+{
+    if (!enabled)
+        return RibbonStyle::DISABLED;
+    return checked ? RibbonStyle::ACTIVE : RibbonStyle::NORMAL;
+}
+
+bool CommandState::operator==(const CommandState &other) const
+{
+    return enabled == other.enabled && checked == other.checked && badge == other.badge;
+}
+
+CommandStateStore::CommandStateStore(int capacity)
+    : mCapacity(std::max(0, capacity)), mWords(new std::atomic<quint32>[std::max(0, capacity)]),
+      mDirty(new std::atomic<quint64>[(std::max(0, capacity) + 63) / 64]), mPending(false),
+      mDrained(size_t(std::max(0, capacity)), 0)
+{
+    for (int i = 0; i < mCapacity; i++)
+        mWords[i].store(0, std::memory_order_relaxed);
+    for (int i = 0; i < (mCapacity + 63) / 64; i++)
+        mDirty[i].store(0, std::memory_order_relaxed);
+}
+
+int CommandStateStore::capacity(void) const
+{
+    return mCapacity;
+}
+
+void CommandStateStore::setEnabled(CommandId command, bool enabled)
+{
+    modify(command, DisabledBit, enabled ? 0 : DisabledBit);
+}
+
+void CommandStateStore::setChecked(CommandId command, bool checked)
+{
+    modify(command, CheckedBit, checked ? CheckedBit : 0);
+}
+
+void CommandStateStore::setBadge(CommandId command, int badge)
+{
+    modify(command, BadgeMask, quint32(qBound(0, badge, 0xffff)) << BadgeShift);
+}
+
+void CommandStateStore::setState(CommandId command, const CommandState &state)
+{
+    modify(command, DisabledBit | CheckedBit | BadgeMask, pack(state));
+}
+
+CommandState CommandStateStore::state(CommandId command) const
+{
+    if (command < 0 || command >= mCapacity)
+        return CommandState();
+    return unpack(mWords[command].load(std::memory_order_acquire));
+}
+
+bool CommandStateStore::setNotifier(const std::function<void(void)> &notifier)
+{
+    QMutexLocker lock(&mNotifierMutex);
+    if (notifier && mNotifier)
+        return false;
+    mNotifier = notifier;
+    return true;
+}
+
+bool CommandStateStore::isPending(void) const
+{
+    return mPending.load(std::memory_order_relaxed);
+}
+
+int CommandStateStore::drain(std::vector<CommandChange>* changes)
+{
+    // Cleared first: an update racing with the scan notifies again and is found by the next drain
+    mPending.store(false);
+    mStats.drains++;
+
+    int count = 0;
+    for (int block = 0; block < (mCapacity + 63) / 64; block++) {
+        if (mDirty[block].load() == 0)
+            continue;
+
+        quint64 bits = mDirty[block].exchange(0);
+        while (bits != 0) {
+            int bit = 0;
+            while ((bits & (quint64(1) << bit)) == 0)
+                bit++;
+            bits &= bits - 1;
+
+            CommandId command = block * 64 + bit;
+            quint32 word = mWords[command].load(std::memory_order_acquire);
+            if (word == mDrained[command]) {
+                mStats.unchanged++;
+                continue;
+            }
+
+            if (changes != nullptr)
+                changes->push_back({command, unpack(mDrained[command]), unpack(word)});
+            mDrained[command] = word;
+            count++;
+        }
+    }
+
+    mStats.changes += count;
+    return count;
+}
+
+CommandStateStats CommandStateStore::stats(void) const
+{
+    return mStats;
+}
+
+quint32 CommandStateStore::pack(const CommandState &state)
+{
+    return (state.enabled ? 0 : DisabledBit) | (state.checked ? CheckedBit : 0)
+        | (quint32(qBound(0, state.badge, 0xffff)) << BadgeShift);
+}
+
+CommandState CommandStateStore::unpack(quint32 word)
+{
+    CommandState ret;
+    ret.enabled = (word & DisabledBit) == 0;
+    ret.checked = (word & CheckedBit) != 0;
+    ret.badge = int(word >> BadgeShift);
+    return ret;
+}
+
+void CommandStateStore::modify(CommandId command, quint32 mask, quint32 bits)
+{
+    if (command < 0 || command >= mCapacity)
+        return;
+
+    std::atomic<quint32> &word = mWords[command];
+    quint32 old = word.load(std::memory_order_relaxed);
+    quint32 value;
+    do {
+        value = (old & ~mask) | bits;
+        if (value == old)
+            return;
+    } while (!word.compare_exchange_weak(old, value, std::memory_order_release, std::memory_order_relaxed));
+
+    // The thread setting the dirty bit makes the store pending. Sequentially consistent with drain(), which
+    // clears the pending flag before the bitmap: a bit set after the flag was cleared notifies again.
+    const quint64 bit = quint64(1) << (command % 64);
+    if ((mDirty[command / 64].fetch_or(bit) & bit) == 0 && !mPending.exchange(true)) {
+        // Under the lock, so that the consumer can't go away during the call
+        QMutexLocker lock(&mNotifierMutex);
+        if (mNotifier)
+            mNotifier();
+    }
+}
+
+}
@@ -19,46 +19,64 @@
 
 #include "CustomWindow.hh"
 
-#ifdef Q_OS_WIN
-    #include <QSysInfo>
-    #include <QApplication>
-    #include <QPainter>
-    #include <QStyle>
-    #include <QStylePainter>
-    #include <QStyleOption>
-    #include <QMouseEvent>
-    #include <QScreen>
-	#include <QLayout>
-
-static const long ncHitZone[3][4] = {
-	{HTTOPLEFT, HTLEFT, HTLEFT, HTBOTTOMLEFT},
-	{HTTOP, HTCAPTION, HTNOWHERE, HTBOTTOM},
-	{HTTOPRIGHT, HTRIGHT, HTRIGHT, HTBOTTOMRIGHT}
-};
+#include "FrameBackend/FrameBackend.hh"
+#include "FrameBackend/SystemState.hh"
+
+#include <QSysInfo>
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+#include <QStylePainter>
+#include <QStyleOption>
+#include <QMouseEvent>
+#include <QResizeEvent>
+#include <QScreen>
+#include <QLayout>
+#include <algorithm>
 
+#ifdef Q_OS_WIN
+    #include "FrameBackend/Win32.hh"
 #endif
 
 #ifdef __MINGW32__
     #define WM_DWMCOMPOSITIONCHANGED 0x031E
 #endif
 
+#if defined(Q_OS_WIN) && !defined(WM_DPICHANGED)
+    #define WM_DPICHANGED 0x02E0
+#endif
+
 namespace CustomWindow {
 
 CustomWindow::CustomWindow(QWidget* parent, Qt::WindowFlags flags) : QWidget(parent, flags) {
+	STARTUP_SCOPE("CustomWindow::CustomWindow");
+	{
+		STARTUP_SCOPE("FrameBackend::create");
+		mBackend = FrameBackend::create(this);
+	}
+
 #ifdef Q_OS_WIN
-    setAttribute(Qt::WA_TranslucentBackground, true);
+	{
+		STARTUP_SCOPE("setAttribute");
+		setAttribute(Qt::WA_TranslucentBackground, true);
+	}
+#endif
 
     mCanMove = false;
     mFrameRemoved = false;
     mMargins = QMargins(0, 0, 0, 0);
-    setTitleBarSize(-1);
-    setBorderSize(-1);
-    mTitleBarHover = QStyle::SC_None;
-    mTitleBarState = QStyle::State_None;
+	{
+		STARTUP_SCOPE("setTitleBarSize/setBorderSize");
+		setTitleBarSize(-1);
+		setBorderSize(-1);
+	}
     mSizingMethod = contentSizing;
 	mTransluentWindow = false;
+	mBlurBehindOpacity = 0.5;
 
+#ifdef Q_OS_WIN
     // Patch for Windows 10 (If not, the border size is 8px).
+	STARTUP_SCOPE("QSysInfo::productVersion");
     if (QSysInfo::productVersion() == "10")
         setBorderSize(1);
 #endif
@@ -66,15 +84,28 @@ CustomWindow::CustomWindow(QWidget* parent, Qt::WindowFlags flags) : QWidget(par
 
 CustomWindow::~CustomWindow()
 {
-}
+	// Child captions are deleted by ~QWidget, after our members: they must not call us back
+	for (const QWidget* widget : mCaptions) {
+		disconnect(widget, nullptr, this, nullptr);
+		watchCaption(widget, false);
+	}
+	mCaptions.clear();
 
-#ifdef Q_OS_WIN
+	delete mBackend;
+}
 
 int CustomWindow::borderSize(void) const {
-	if (mBorderSize < 0)
-		return style()->pixelMetric(QStyle::PM_MDIFrameWidth);
+	return frameMetrics().border;
+}
 
-	return (mBorderSize);
+void CustomWindow::changeEvent(QEvent* eve)
+{
+	if (eve->type() == QEvent::StyleChange)
+		invalidateFrameMetrics();
+	else if (eve->type() == QEvent::WindowStateChange)
+		mTitleBarGeometryDirty = true;
+
+	QWidget::changeEvent(eve);
 }
 
 QRect CustomWindow::clientGeometry(void) const {
@@ -86,21 +117,26 @@ QRect CustomWindow::clientGeometry(int flags) const {
 	int border = (mFrameRemoved && (flags & CALCSIZE_USE_BORDER)) ? borderSize() : 0;
 	int titlebar = (mFrameRemoved && (flags & CALCSIZE_USE_TITLEBAR)) ? titleBarSize() : 0;
 
-	QRect ret(margins.left() + border, margins.top() + border + titlebar, width() - margins.left() - margins.right() - 2 * border,
-		height() - margins.top() - margins.bottom() - 2 * border - titlebar);
-
-	return ret;
+	return FrameLogic::clientGeometry(QWidget::size(), margins, border, titlebar);
 }
 
 void CustomWindow::disableTransluentBackground(void)
 {
 	mTransluentWindow = false;
-	DisableWindowBlur();
+	mBackend->setBlurBehind(false);
 }
 
 void CustomWindow::declareCaption(const QWidget* widget)
 {
+	if (std::find(mCaptions.begin(), mCaptions.end(), widget) != mCaptions.end())
+		return;
+
 	mCaptions.push_back(widget);
+	mCaptionIndexDirty = true;
+
+	// Caption geometry is cached, so we need to know when it (or an ancestor) changes
+	watchCaption(widget, true);
+	connect(widget, &QObject::destroyed, this, [this, widget]() { removeCaption(widget); });
 }
 
 void CustomWindow::enableTransluentBackground(QColor color, qreal opacity)
@@ -108,36 +144,51 @@ void CustomWindow::enableTransluentBackground(QColor color, qreal opacity)
 	mBackgroundColor = color;
 	mBlurBehindOpacity = opacity;
 	mTransluentWindow = true;
-	EnableWindowBlur();
+	mBackend->setBlurBehind(true);
 }
 
 QMargins CustomWindow::extraMargins(void) const {
 	return mMargins;
 }
 
+FrameStats* CustomWindow::frameStats(void) {
+#ifdef RIBBON_INSTRUMENTATION
+	// Named here rather than in the constructor, where the dynamic type is still CustomWindow
+	if (mFrameStats.name().isEmpty())
+		mFrameStats.setName(QString("%1@0x%2").arg(metaObject()->className()).arg(quintptr(this), 0, 16));
+	return &mFrameStats;
+#else
+	return nullptr;
+#endif
+}
+
+const FrameMetrics& CustomWindow::frameMetrics(void) const {
+	if (mFrameMetricsDirty) {
+		mFrameMetrics.mdiFrameWidth = style()->pixelMetric(QStyle::PM_MdiSubWindowFrameWidth);
+		mFrameMetrics.titleBarHeight = style()->pixelMetric(QStyle::PM_TitleBarHeight);
+		mFrameMetrics.border = mBorderSize < 0 ? style()->pixelMetric(QStyle::PM_MDIFrameWidth) : mBorderSize;
+		mFrameMetrics.titleBar = mTitleBarSize < 0 ? mFrameMetrics.titleBarHeight - mFrameMetrics.mdiFrameWidth : mTitleBarSize;
+		mFrameMetricsDirty = false;
+	}
+
+	return mFrameMetrics;
+}
+
 int CustomWindow::geometryFlags(void) const {
 	return mGeometryFlags;
 }
 
 bool CustomWindow::hasControls(int cx, int cy) {
-	QStyleOptionTitleBar title;
-	title.initFrom(this);
-	title.titleBarFlags = windowFlags();
-	title.rect.setRect(0, 0, width(), style()->pixelMetric(QStyle::PM_TitleBarHeight));
+	if (mTitleBarGeometryDirty)
+		updateTitleBarGeometry();
 
-	if (style()->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarCloseButton, nullptr).contains(cx, cy))
-		return true;
-	if (style()->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarMaxButton, nullptr).contains(cx, cy))
-		return true;
-	if (style()->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarMinButton, nullptr).contains(cx, cy))
-		return true;
-	if (style()->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarNormalButton, nullptr).contains(cx, cy))
+	if (mHitButtons.close.contains(cx, cy) || mHitButtons.max.contains(cx, cy)
+		|| mHitButtons.min.contains(cx, cy) || mHitButtons.normal.contains(cx, cy))
 		return true;
 
-	RECT rcWin;
-	GetWindowRect(reinterpret_cast<HWND>(winId()), &rcWin);
+	QPoint origin = mBackend->frameGeometry().topLeft();
 
-	QWidget* w = QApplication::widgetAt(cx + rcWin.left, cy + rcWin.top);
+	QWidget* w = QApplication::widgetAt(cx + origin.x(), cy + origin.y());
 	if (w != nullptr && w != this)
 		return true;
 
@@ -151,40 +202,87 @@ bool CustomWindow::hasTransluentBackground(void) const
 
 bool CustomWindow::haveSystemMenu(void) const
 {
-	return GetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE) & WS_SYSMENU;
+	return mBackend->hasSystemMenu();
 }
 
 void CustomWindow::hideSystemMenu(void)
 {
-	SetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE, GetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE) & ~WS_SYSMENU);
+	mBackend->setSystemMenu(false);
+}
+
+HitZone CustomWindow::hitTest(const QPoint& pos) {
+	FRAME_PROBE(mFrameStats, ProbeHitTest);
+
+	if (hasControls(pos.x(), pos.y()))
+	{
+		if (isCaption(pos.x(), pos.y()))
+			return HitCaption;
+		else
+			return HitClient;
+	}
+
+	return FrameLogic::hitZone(pos, mBackend->frameGeometry().size(), borderSize(), titleBarSize());
+}
+
+void CustomWindow::invalidateFrameMetrics(void) {
+	// Title bar buttons depend on the metrics
+	mFrameMetricsDirty = true;
+	mTitleBarGeometryDirty = true;
 }
 
 bool CustomWindow::isAeroActivated(void) {
-	BOOL isDwmEnabled;
-	HRESULT hr;
+	return SystemState::isCompositionEnabled();
+}
+
+bool CustomWindow::event(QEvent* eve)
+{
+	// Moving to a screen with another DPI changes the style metrics
+	if (eve->type() == QEvent::ScreenChangeInternal)
+		invalidateFrameMetrics();
+
+#ifdef RIBBON_INSTRUMENTATION
+	// Paint of the subclass included, its end is the first frame of the startup trace
+	if (eve->type() == QEvent::Paint && StartupTrace::isRecording()) {
+		bool ret;
+		{
+			STARTUP_SCOPE("first paintEvent");
+			ret = QWidget::event(eve);
+		}
+		STARTUP_FIRST_PAINT();
+		return ret;
+	}
+#endif
+
+	return QWidget::event(eve);
+}
 
-	if (QSysInfo::windowsVersion() < QSysInfo::WV_VISTA)
-		return false;
+bool CustomWindow::eventFilter(QObject* watched, QEvent* eve)
+{
+	switch (eve->type()) {
+	case QEvent::Move:
+	case QEvent::Resize:
+	case QEvent::LayoutRequest:
+		mCaptionIndexDirty = true;
+		break;
+	case QEvent::ParentChange:
+		// New ancestors to watch
+		mCaptionIndexDirty = true;
+		for (const QWidget* widget : mCaptions)
+			watchCaption(widget, true);
+		break;
+	default:
+		break;
+	}
 
-	hr = DwmIsCompositionEnabled(&isDwmEnabled);
-	if (hr < 0)
-		return false;
-	return isDwmEnabled == TRUE;
+	return QWidget::eventFilter(watched, eve);
 }
 
 bool CustomWindow::isCaption(int cx, int cy) const
 {
-	for (const auto* widget : mCaptions) {
-		QPoint wpos = widget->mapToGlobal(QPoint(0, 0)) - pos();
-		int minX = wpos.x();
-		int minY = wpos.y();
-		int maxX = minX + widget->size().width();
-		int maxY = minY + widget->size().height();
+	if (mCaptionIndexDirty)
+		updateCaptionIndex();
 
-		if (minX <= cx && cx <= maxX && minY <= cy && cy <= maxY)
-			return true;
-	}
-	return false;
+	return mCaptionIndex.contains(cx, cy);
 }
 
 bool CustomWindow::isFrameRemoved(void) const {
@@ -196,40 +294,58 @@ bool CustomWindow::isGeometryFlagsActivated(int flag) const {
 }
 
 bool CustomWindow::isThemeActivated(void) {
-	if (QSysInfo::windowsVersion() < QSysInfo::WV_XP)
-		return (false);
-
-	return IsThemeActive() == TRUE;
+	return SystemState::isThemeActive();
 }
 
 void CustomWindow::mouseMoveEvent(QMouseEvent* eve) {
-	RECT realWin;
-	GetWindowRect(reinterpret_cast<HWND>(winId()), &realWin);
+	if (mCanMove) {
+		move(eve->globalPos() - mStartPos);
+		return;
+	}
 
-	ncMouseMove(eve->globalX() - realWin.left,
-		eve->globalY() - realWin.top);
+	QPoint pos = eve->globalPos() - mBackend->frameGeometry().topLeft();
+	ncMouseMove(pos.x(), pos.y());
+
+	// Without native hit test, resize cursors are ours to show
+	if (mFrameRemoved && !mBackend->hasNativeHitTest() && eve->buttons() == Qt::NoButton)
+		setCursor(FrameLogic::cursorShape(hitTest(pos)));
 }
 
 void CustomWindow::mousePressEvent(QMouseEvent* eve) {
-	RECT realWin;
-	GetWindowRect(reinterpret_cast<HWND>(winId()), &realWin);
+	QPoint pos = eve->globalPos() - mBackend->frameGeometry().topLeft();
+	ncMousePress(pos.x(), pos.y());
+
+	if (!mFrameRemoved || mBackend->hasNativeHitTest() || eve->button() != Qt::LeftButton
+		|| mTitleBar.hover() != QStyle::SC_None)
+		return;
 
-	ncMousePress(eve->globalX() - realWin.left,
-		eve->globalY() - realWin.top);
+	HitZone zone = hitTest(pos);
+	if (zone == HitCaption) {
+		// Fallback to a move done by hand if the window manager can't do it
+		if (!mBackend->startSystemMove()) {
+			mCanMove = true;
+			mStartPos = eve->globalPos() - mBackend->frameGeometry().topLeft();
+		}
+	}
+	else if (FrameLogic::resizeEdges(zone)) {
+		mBackend->startSystemResize(FrameLogic::resizeEdges(zone));
+	}
 }
 
 void CustomWindow::mouseReleaseEvent(QMouseEvent* eve) {
-	RECT realWin;
-	GetWindowRect(reinterpret_cast<HWND>(winId()), &realWin);
+	mCanMove = false;
 
-	ncMouseRelease(eve->globalX() - realWin.left,
-		eve->globalY() - realWin.top);
+	QPoint pos = eve->globalPos() - mBackend->frameGeometry().topLeft();
+	ncMouseRelease(pos.x(), pos.y());
 }
 
+#ifdef Q_OS_WIN
 bool CustomWindow::nativeEvent(const QByteArray &eventType, void* message, long* result) {
     Q_UNUSED(eventType);
     MSG* wMsg = reinterpret_cast<MSG*>(message);
     UINT wMessage = wMsg->message;
+    FRAME_PROBE(mFrameStats, ProbeNativeEvent);
+    FRAME_MESSAGE(mFrameStats, wMessage);
     bool hasHandled = false;
     long res = 0;
 
@@ -245,8 +361,10 @@ bool CustomWindow::nativeEvent(const QByteArray &eventType, void* message, long*
     }
 
     if (wMessage == WM_NCHITTEST && res == 0 && mFrameRemoved) {
-        if (!(res == HTCLOSE || res == HTMAXBUTTON || res == HTMINBUTTON || res == HTHELP))
-            res = ncHitTest(wMsg);
+        if (!(res == HTCLOSE || res == HTMAXBUTTON || res == HTMINBUTTON || res == HTHELP)) {
+            QPoint cur(GET_X_LPARAM(wMsg->lParam), GET_Y_LPARAM(wMsg->lParam));
+            res = Win32FrameBackend::toNative(hitTest(cur - mBackend->frameGeometry().topLeft()));
+        }
 
         if (res != HTNOWHERE)
             hasHandled = true;
@@ -254,6 +372,8 @@ bool CustomWindow::nativeEvent(const QByteArray &eventType, void* message, long*
 
     if (wMessage == WM_DWMCOMPOSITIONCHANGED
         || wMessage == WM_THEMECHANGED) {
+        SystemState::refresh();
+        invalidateFrameMetrics();
         updateFrame();
         if (isAeroActivated()) {
             updateMargins();
@@ -264,7 +384,11 @@ bool CustomWindow::nativeEvent(const QByteArray &eventType, void* message, long*
         }
         emit themeChanged();
 
-        repaint();
+        update();
+    }
+
+    if (wMessage == WM_DPICHANGED) {
+        invalidateFrameMetrics();
     }
 
     if (wMessage == WM_NCPAINT && !isThemeActivated()) {
@@ -287,118 +411,47 @@ bool CustomWindow::nativeEvent(const QByteArray &eventType, void* message, long*
         *result = res;
     return hasHandled;
 }
-
-long CustomWindow::ncHitTest(MSG* wMsg) {
-	QPoint cur(GET_X_LPARAM(wMsg->lParam), GET_Y_LPARAM(wMsg->lParam));
-	UINT8 xPos = 1;
-	UINT8 yPos = 2;
-
-	RECT rcWin;
-	GetWindowRect(wMsg->hwnd, &rcWin);
-
-	if (hasControls(cur.x() - rcWin.left, cur.y() - rcWin.top))
-	{
-		if (isCaption(cur.x() - rcWin.left, cur.y() - rcWin.top))
-			return HTCAPTION;
-		else
-			return HTCLIENT;
-	}
-
-	RECT rcFrame = { 0 };
-	AdjustWindowRectEx(&rcFrame, WS_OVERLAPPEDWINDOW & ~WS_CAPTION, FALSE, NULL);
-
-	if (cur.y() >= rcWin.top && cur.y() <= rcWin.top + borderSize())
-		yPos = 0;
-	else if (cur.y() >= rcWin.top + borderSize() && cur.y() <= rcWin.top + borderSize() + titleBarSize())
-		yPos = 1;
-	else if (cur.y() >= rcWin.bottom - borderSize() && cur.y() < rcWin.bottom)
-		yPos = 3;
-
-	if (cur.x() >= rcWin.left && cur.x() < rcWin.left + borderSize())
-		xPos = 0;
-	else if (cur.x() >= rcWin.right - borderSize() && cur.x() < rcWin.right)
-		xPos = 2;
-
-	return ncHitZone[xPos][yPos];
-}
+#endif
 
 void CustomWindow::ncMouseMove(int cx, int cy) {
 	if (!mFrameRemoved || isAeroActivated()) {
-		mTitleBarHover = QStyle::SC_None;
-		mTitleBarState = QStyle::State_None;
+		mTitleBar.reset();
 		return;
 	}
 
-	QStyleOptionTitleBar title;
-	title.initFrom(this);
-	title.titleBarFlags = windowFlags();
-	if (isThemeActivated())
-		title.rect.setRect(0, 0, width(), style()->pixelMetric(QStyle::PM_TitleBarHeight));
-	else
-		title.rect.setRect(borderSize(), borderSize(), width() - 2 * borderSize(),
-			style()->pixelMetric(QStyle::PM_TitleBarHeight));
+	if (mTitleBarGeometryDirty)
+		updateTitleBarGeometry();
 
-	if (style()->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarCloseButton, nullptr).contains(cx, cy)) {
-		if (mTitleBarHover != QStyle::SC_TitleBarCloseButton) {
-			mTitleBarHover = QStyle::SC_TitleBarCloseButton;
-			mTitleBarState = QStyle::State_MouseOver;
-			repaint();
-		}
-	}
-	else if (style()->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarMaxButton, nullptr).contains(cx, cy) && !isMaximized()) {
-		if (mTitleBarHover != QStyle::SC_TitleBarMaxButton) {
-			mTitleBarHover = QStyle::SC_TitleBarMaxButton;
-			mTitleBarState = QStyle::State_MouseOver;
-			repaint();
-		}
-	}
-	else if (style()->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarMinButton, nullptr).contains(cx, cy)) {
-		if (mTitleBarHover != QStyle::SC_TitleBarMinButton) {
-			mTitleBarHover = QStyle::SC_TitleBarMinButton;
-			mTitleBarState = QStyle::State_MouseOver;
-			repaint();
-		}
-	}
-	else if (style()->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarMaxButton, nullptr).contains(cx, cy) && isMaximized()) {
-		if (mTitleBarHover != QStyle::SC_TitleBarNormalButton) {
-			mTitleBarHover = QStyle::SC_TitleBarNormalButton;
-			mTitleBarState = QStyle::State_MouseOver;
-			repaint();
-		}
-	}
-	else {
-		if (mTitleBarHover != QStyle::SC_None) {
-			mTitleBarHover = QStyle::SC_None;
-			mTitleBarState = QStyle::State_None;
-			repaint();
-		}
-	}
+	QStyle::SubControl previous = mTitleBar.hover();
+	if (mTitleBar.move(QPoint(cx, cy), isMaximized()))
+		updateTitleBarButtons(previous);
 }
 
 void CustomWindow::ncMousePress(int, int) {
-	if (mTitleBarHover != QStyle::SC_None) {
-		mTitleBarState = QStyle::State_Sunken;
-		repaint();
-	}
+	if (mTitleBar.press())
+		updateTitleBarButtons(mTitleBar.hover());
 }
 
 void CustomWindow::ncMouseRelease(int, int) {
-	if (mTitleBarState == QStyle::State_Sunken) {
-		mTitleBarState = QStyle::State_MouseOver;
-		repaint();
-
-		if (mTitleBarHover == QStyle::SC_TitleBarCloseButton)
-			close();
-		else if (mTitleBarHover == QStyle::SC_TitleBarMaxButton)
-			showMaximized();
-		else if (mTitleBarHover == QStyle::SC_TitleBarMinButton)
-			showMinimized();
-		else if (mTitleBarHover == QStyle::SC_TitleBarNormalButton)
-			showNormal();
-	}
+	QStyle::SubControl button = mTitleBar.release();
+	if (button == QStyle::SC_None)
+		return;
+
+	updateTitleBarButtons(button);
+
+	if (button == QStyle::SC_TitleBarCloseButton)
+		close();
+	else if (button == QStyle::SC_TitleBarMaxButton)
+		showMaximized();
+	else if (button == QStyle::SC_TitleBarMinButton)
+		showMinimized();
+	else if (button == QStyle::SC_TitleBarNormalButton)
+		showNormal();
 }
 
-void CustomWindow::paintEvent(QPaintEvent*) {
+void CustomWindow::paintEvent(QPaintEvent* eve) {
+	FRAME_PROBE(mFrameStats, ProbePaintEvent);
+
 	if (isAeroActivated()) {
 		if (!(mTransluentWindow && mBlurBehindOpacity <= 0.0))
 		{
@@ -435,7 +488,7 @@ void CustomWindow::paintEvent(QPaintEvent*) {
 	}
 	else {
 		if (mFrameRemoved) {
-			paintWinFrame();
+			paintWinFrame(eve->region());
 		}
 		else {
 			QPainter p(this);
@@ -448,13 +501,29 @@ void CustomWindow::paintEvent(QPaintEvent*) {
 	}
 }
 
-void CustomWindow::paintWinFrame(void) {
+void CustomWindow::paintWinFrame(const QRegion& dirty) {
+	FRAME_PROBE(mFrameStats, ProbePaintWinFrame);
+
 	QStylePainter p;
 	p.begin(this);
 
+	QStyleOptionTitleBar title;
+	title.initFrom(this);
+	if (isThemeActivated())
+		title.rect.setRect(0, 0, width(), borderSize() + titleBarSize());
+	else
+		title.rect.setRect(borderSize(), borderSize(), width() - 2 * borderSize(),
+			titleBarSize() + frameMetrics().mdiFrameWidth);
+
+	// Only title bar buttons changed (hover or press): the frame around is still valid
+	bool titleBarOnly = title.rect.contains(dirty.boundingRect());
+
 	p.setPen(Qt::NoPen);
 	p.setBrush(palette().window());
-	p.drawRect(0, 0, width(), height());
+	if (titleBarOnly)
+		p.drawRect(dirty.boundingRect());
+	else
+		p.drawRect(0, 0, width(), height());
 
 	QPalette pal = palette();
 	if (isActiveWindow())
@@ -466,13 +535,6 @@ void CustomWindow::paintWinFrame(void) {
 	frame.initFrom(this);
 	frame.lineWidth = borderSize();
 
-	QStyleOptionTitleBar title;
-	title.initFrom(this);
-	if (isThemeActivated())
-		title.rect.setRect(0, 0, width(), borderSize() + titleBarSize());
-	else
-		title.rect.setRect(borderSize(), borderSize(), width() - 2 * borderSize(),
-			titleBarSize() + style()->pixelMetric(QStyle::PM_MdiSubWindowFrameWidth));
 	title.state = isActiveWindow() ? QStyle::State_Active : QStyle::State_None;
 	title.palette = pal;
 	title.titleBarState = title.state;
@@ -481,19 +543,20 @@ void CustomWindow::paintWinFrame(void) {
 	title.subControls = title.subControls & ~QStyle::SC_TitleBarSysMenu;
 	title.activeSubControls = nullptr;
 
-	p.drawPrimitive(QStyle::PE_FrameWindow, frame);
+	if (!titleBarOnly)
+		p.drawPrimitive(QStyle::PE_FrameWindow, frame);
 	p.drawComplexControl(QStyle::CC_TitleBar, title);
 
 	title.subControls &= ~QStyle::SC_TitleBarLabel;
 	title.titleBarFlags = windowFlags();
-	title.activeSubControls = mTitleBarHover;
-	title.state = mTitleBarState;
+	title.activeSubControls = mTitleBar.hover();
+	title.state = mTitleBar.state();
 	if (isThemeActivated())
-		title.rect.setRect(0, 0 - style()->pixelMetric(QStyle::PM_MdiSubWindowFrameWidth), width(),
-			style()->pixelMetric(QStyle::PM_TitleBarHeight) + style()->pixelMetric(QStyle::PM_MdiSubWindowFrameWidth));
+		title.rect.setRect(0, 0 - frameMetrics().mdiFrameWidth, width(),
+			frameMetrics().titleBarHeight + frameMetrics().mdiFrameWidth);
 	else
 		title.rect.setRect(borderSize(), borderSize(), width() - 2 * borderSize(),
-			style()->pixelMetric(QStyle::PM_TitleBarHeight));
+			frameMetrics().titleBarHeight);
 
 	p.drawComplexControl(QStyle::CC_TitleBar, title);
 
@@ -502,11 +565,23 @@ void CustomWindow::paintWinFrame(void) {
 
 void CustomWindow::removeCaption(const QWidget* widget)
 {
-	for (int i = 0; i < mCaptions.size(); i++) {
-		if (mCaptions[i] == widget) {
-			mCaptions.erase(mCaptions.begin() + i);
-		}
-	}
+	auto it = std::find(mCaptions.begin(), mCaptions.end(), widget);
+	if (it == mCaptions.end())
+		return;
+
+	mCaptions.erase(it);
+	mCaptionIndexDirty = true;
+
+	const_cast<QWidget*>(widget)->removeEventFilter(this);
+	disconnect(widget, &QObject::destroyed, this, nullptr);
+}
+
+void CustomWindow::resizeEvent(QResizeEvent* eve)
+{
+	// Layout of the window moves the captions without them being resized
+	mCaptionIndexDirty = true;
+	mTitleBarGeometryDirty = true;
+	QWidget::resizeEvent(eve);
 }
 
 void CustomWindow::resize(int w, int h, Sizing method)
@@ -528,6 +603,7 @@ void CustomWindow::setBorderSize(int size) {
 		mBorderSize = -1;
 	else
 		mBorderSize = size;
+	invalidateFrameMetrics();
 
 	if (mFrameRemoved) {
 		updateFrame();
@@ -581,6 +657,7 @@ void CustomWindow::setTitleBarSize(int size) {
 		mTitleBarSize = -1;
 	else
 		mTitleBarSize = size;
+	invalidateFrameMetrics();
 
 	if (mFrameRemoved) {
 		updateFrame();
@@ -591,7 +668,7 @@ void CustomWindow::setTitleBarSize(int size) {
 
 void CustomWindow::showSystemMenu(void)
 {
-	SetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE, GetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE) | WS_SYSMENU);
+	mBackend->setSystemMenu(true);
 }
 
 QSize CustomWindow::size(Sizing method) const
@@ -609,136 +686,133 @@ Sizing CustomWindow::sizing(void) const
 	return mSizingMethod;
 }
 
-int CustomWindow::titleBarSize(void) const {
-	if (mTitleBarSize < 0)
-		// if (isThemeActivated()) {
-		return style()->pixelMetric(QStyle::PM_TitleBarHeight)
-		- style()->pixelMetric(QStyle::PM_MdiSubWindowFrameWidth);
-	// } else {
-	//	return style()->pixelMetric(QStyle::PM_TitleBarHeight);
-	//}
+QRect CustomWindow::titleBarButtonRect(QStyle::SubControl button) const
+{
+	switch (button) {
+	case QStyle::SC_TitleBarCloseButton:
+		return mPaintButtons.close;
+	case QStyle::SC_TitleBarMaxButton:
+		return mPaintButtons.max;
+	case QStyle::SC_TitleBarMinButton:
+		return mPaintButtons.min;
+	case QStyle::SC_TitleBarNormalButton:
+		// Hover of the normal button is detected on the max button rect
+		return mPaintButtons.normal | mPaintButtons.max;
+	default:
+		return QRect();
+	}
+}
 
-	return (mTitleBarSize);
+int CustomWindow::titleBarSize(void) const {
+	return frameMetrics().titleBar;
 }
 
 qreal CustomWindow::transluentBackgroundOpacity(void) const {
 	return mBlurBehindOpacity;
 }
 
-void CustomWindow::updateFrame(HWND hWnd) {
-    if (hWnd == nullptr)
-        hWnd = reinterpret_cast<HWND>(winId());
+void CustomWindow::watchCaption(const QWidget* widget, bool watch)
+{
+	// Installing twice is harmless: the filter is moved to the front, not duplicated
+	for (QWidget* w = const_cast<QWidget*>(widget); w != nullptr && w != this; w = w->parentWidget()) {
+		if (watch)
+			w->installEventFilter(this);
+		else
+			w->removeEventFilter(this);
+		if (w->isWindow())
+			break;
+	}
+}
+
+void CustomWindow::updateCaptionIndex(void) const
+{
+	std::vector<QRect> rects;
+	rects.reserve(mCaptions.size());
 
-    RECT rcClient;
-    GetWindowRect(hWnd, &rcClient);
+	for (const auto* widget : mCaptions) {
+		QPoint wpos = widget->mapToGlobal(QPoint(0, 0)) - pos();
+		rects.emplace_back(wpos, widget->size());
+	}
 
-    SetWindowPos(hWnd, nullptr, rcClient.left, rcClient.top,
-        rcClient.right - rcClient.left,
-        rcClient.bottom - rcClient.top, SWP_FRAMECHANGED);
+	mCaptionIndex.build(rects);
+	mCaptionIndexDirty = false;
 }
 
-void CustomWindow::updateLayoutMargins(void)
+static void titleBarButtons(const QStyle* style, const QStyleOptionTitleBar& title, QRect* close, QRect* max, QRect* min, QRect* normal)
 {
-	if (layout() == 0)
-		return;
-	layout()->setContentsMargins(clientGeometry().left() + mLayoutMargins.left(),
-		clientGeometry().top() + mLayoutMargins.top(),
-		(width() - clientGeometry().left() - clientGeometry().width()) + mLayoutMargins.right(),
-		(height() - clientGeometry().top() - clientGeometry().height()) + mLayoutMargins.bottom());
+	*close = style->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarCloseButton, nullptr);
+	*max = style->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarMaxButton, nullptr);
+	*min = style->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarMinButton, nullptr);
+	*normal = style->subControlRect(QStyle::CC_TitleBar, &title, QStyle::SC_TitleBarNormalButton, nullptr);
 }
 
-void CustomWindow::updateMargins(HWND hWnd) {
-	if (hWnd == nullptr)
-		hWnd = reinterpret_cast<HWND>(winId());
+void CustomWindow::updateTitleBarGeometry(void)
+{
+	QStyleOptionTitleBar title;
+	title.initFrom(this);
+	title.titleBarFlags = windowFlags();
+	int height = frameMetrics().titleBarHeight;
 
-	MARGINS mar;
-	mar.cxLeftWidth = mMargins.left();
-	mar.cxRightWidth = mMargins.right();
-	mar.cyBottomHeight = mMargins.bottom();
-	mar.cyTopHeight = mMargins.top();
+	// Hit test always use the full width title bar
+	title.rect.setRect(0, 0, width(), height);
+	titleBarButtons(style(), title, &mHitButtons.close, &mHitButtons.max, &mHitButtons.min, &mHitButtons.normal);
 
-	if (mFrameRemoved) {
-		mar.cxLeftWidth += borderSize();
-		mar.cxRightWidth += borderSize();
-		mar.cyBottomHeight += borderSize();
-		mar.cyTopHeight += titleBarSize() + borderSize();
+	// Hover follows the painted title bar, inside the border without theme
+	TitleBarControls::Buttons hover = mHitButtons;
+	if (!isThemeActivated()) {
+		title.rect.setRect(borderSize(), borderSize(), width() - 2 * borderSize(), height);
+		titleBarButtons(style(), title, &hover.close, &hover.max, &hover.min, &hover.normal);
+	}
+	mTitleBar.setButtons(hover);
+
+	// Painted buttons are shifted by the MDI frame when themed (see paintWinFrame)
+	if (isThemeActivated()) {
+		int frame = frameMetrics().mdiFrameWidth;
+		title.rect.setRect(0, -frame, width(), height + frame);
+		titleBarButtons(style(), title, &mPaintButtons.close, &mPaintButtons.max, &mPaintButtons.min, &mPaintButtons.normal);
+		mPaintButtons.close |= hover.close;
+		mPaintButtons.max |= hover.max;
+		mPaintButtons.min |= hover.min;
+		mPaintButtons.normal |= hover.normal;
+	}
+	else {
+		mPaintButtons = hover;
 	}
 
-	DwmExtendFrameIntoClientArea(hWnd, &mar);
+	mTitleBarGeometryDirty = false;
 }
 
-void CustomWindow::EnableWindowBlur(void)
-{
-	const HINSTANCE hModule = LoadLibrary(TEXT("user32.dll"));
-	if (hModule)
-	{
-		struct ACCENTPOLICY
-		{
-			int nAccentState;
-			int nFlags;
-			int nColor;
-			int nAnimationId;
-		};
-
-		struct WINCOMPATTRDATA
-		{
-			DWORD nAttribute;
-			PVOID pData;
-			ULONG ulDataSize;
-		};
-		
-		typedef BOOL(WINAPI*pSetWindowCompositionAttribute)(HWND, WINCOMPATTRDATA*);
-		const pSetWindowCompositionAttribute SetWindowCompositionAttribute = (pSetWindowCompositionAttribute)GetProcAddress(hModule, "SetWindowCompositionAttribute");
-		if (SetWindowCompositionAttribute)
-		{
-			ACCENTPOLICY policy = { 3, 0, 0, 0 }; // ACCENT_ENABLE_BLURBEHIND=3...
-			WINCOMPATTRDATA data = { 19, &policy, sizeof(ACCENTPOLICY) }; // =19
-			SetWindowCompositionAttribute(reinterpret_cast<HWND>(winId()), &data);
-		}
-		FreeLibrary(hModule);
-	}
+void CustomWindow::updateFrame(void) {
+	mBackend->updateFrame(mFrameRemoved);
 }
 
-void CustomWindow::DisableWindowBlur(void)
+void CustomWindow::updateLayoutMargins(void)
 {
-	struct ACCENTPOLICY
-	{
-		int nAccentState;
-		int nFlags;
-		int nColor;
-		int nAnimationId;
-	};
+	if (layout() == 0)
+		return;
+	layout()->setContentsMargins(FrameLogic::layoutMargins(QWidget::size(), clientGeometry(), mLayoutMargins));
+}
 
-	struct WINCOMPATTRDATA
-	{
-		DWORD nAttribute;
-		PVOID pData;
-		ULONG ulDataSize;
-	};
+void CustomWindow::updateMargins(void) {
+	QMargins margins = mMargins;
 
-	const HINSTANCE hModule = LoadLibrary(TEXT("user32.dll"));
-	if (hModule)
-	{
-		typedef BOOL(WINAPI*pSetWindowCompositionAttribute)(HWND, WINCOMPATTRDATA*);
-		const pSetWindowCompositionAttribute SetWindowCompositionAttribute = (pSetWindowCompositionAttribute)GetProcAddress(hModule, "SetWindowCompositionAttribute");
-		if (SetWindowCompositionAttribute)
-		{
-			ACCENTPOLICY policy = { 0, 0, 0, 0 }; // ACCENT_ENABLE_BLURBEHIND=3...
-			WINCOMPATTRDATA data = { 19, &policy, sizeof(ACCENTPOLICY) }; // =19
-			SetWindowCompositionAttribute(reinterpret_cast<HWND>(winId()), &data);
-		}
-		FreeLibrary(hModule);
+	if (mFrameRemoved) {
+		margins += QMargins(borderSize(), titleBarSize() + borderSize(), borderSize(), borderSize());
 	}
+
+	mBackend->updateMargins(margins);
+}
+
+void CustomWindow::updateTitleBarButtons(QStyle::SubControl previous)
+{
+	// Only the buttons losing and gaining the hover are painted again, on the next event loop iteration
+	update(titleBarButtonRect(previous));
+	update(titleBarButtonRect(mTitleBar.hover()));
 }
 
 void CustomWindow::setResizable(bool resizable)
 {
-	if (!resizable)
-		SetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE, GetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE) | WS_THICKFRAME | WS_OVERLAPPED);
-	else
-		SetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE, GetWindowLong(reinterpret_cast<HWND>(winId()), GWL_STYLE) & ~(WS_THICKFRAME | WS_OVERLAPPED));
+	mBackend->setResizable(resizable);
 }
 
-#endif
-    
 }
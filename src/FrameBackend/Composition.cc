@@ -0,0 +1,101 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "FrameBackend/Composition.hh"
+
+#ifdef Q_OS_WIN
+    #include <Windows.h>
+    #include <mutex>
+
+struct ACCENTPOLICY
+{
+	int nAccentState;
+	int nFlags;
+	int nColor;
+	int nAnimationId;
+};
+
+struct WINCOMPATTRDATA
+{
+	DWORD nAttribute;
+	PVOID pData;
+	ULONG ulDataSize;
+};
+
+typedef BOOL(WINAPI*pSetWindowCompositionAttribute)(HWND, WINCOMPATTRDATA*);
+
+static const DWORD WCA_ACCENT_POLICY = 19;
+
+static pSetWindowCompositionAttribute resolve(void)
+{
+	static std::once_flag once;
+	static pSetWindowCompositionAttribute function = nullptr;
+
+	// user32 is loaded by every GUI process, the handle stays valid without holding a reference
+	std::call_once(once, []() {
+		HMODULE hModule = GetModuleHandle(TEXT("user32.dll"));
+		if (hModule)
+			function = (pSetWindowCompositionAttribute)GetProcAddress(hModule, "SetWindowCompositionAttribute");
+	});
+
+	return function;
+}
+
+#endif
+
+namespace CustomWindow {
+
+bool Composition::isAvailable(void)
+{
+#ifdef Q_OS_WIN
+	return resolve() != nullptr;
+#else
+	return false;
+#endif
+}
+
+bool Composition::setAccent(WId window, const AccentPolicy& policy)
+{
+	return setAccent(QVector<WId>{window}, policy) == 1;
+}
+
+int Composition::setAccent(const QVector<WId>& windows, const AccentPolicy& policy)
+{
+#ifdef Q_OS_WIN
+	pSetWindowCompositionAttribute SetWindowCompositionAttribute = resolve();
+	if (!SetWindowCompositionAttribute)
+		return 0;
+
+	// Color is expected as 0xAABBGGRR
+	QColor color = policy.color.isValid() ? policy.color : QColor(0, 0, 0, 0);
+	int tint = static_cast<int>((uint(color.alpha()) << 24) | (uint(color.blue()) << 16) | (uint(color.green()) << 8) | uint(color.red()));
+	ACCENTPOLICY accent = { policy.state, policy.flags, tint, policy.animationId };
+	WINCOMPATTRDATA data = { WCA_ACCENT_POLICY, &accent, sizeof(ACCENTPOLICY) };
+
+	int count = 0;
+	for (WId window : windows) {
+		if (SetWindowCompositionAttribute(reinterpret_cast<HWND>(window), &data))
+			count++;
+	}
+	return count;
+#else
+	Q_UNUSED(windows);
+	Q_UNUSED(policy);
+	return 0;
+#endif
+}
+
+}
@@ -0,0 +1,37 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "FrameBackend/FrameBackend.hh"
+#include "FrameBackend/Qt.hh"
+#include "FrameBackend/Win32.hh"
+
+namespace CustomWindow {
+
+FrameBackend::FrameBackend(QWidget* window) : mWindow(window) {
+}
+
+FrameBackend::~FrameBackend() {
+}
+
+FrameBackend* FrameBackend::create(QWidget* window) {
+#ifdef Q_OS_WIN
+	return new Win32FrameBackend(window);
+#else
+	return new QtFrameBackend(window);
+#endif
+}
+
+}
@@ -0,0 +1,95 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "FrameBackend/Qt.hh"
+
+#include <QWidget>
+#include <QWindow>
+
+namespace CustomWindow {
+
+QtFrameBackend::QtFrameBackend(QWidget* window) : FrameBackend(window) {
+}
+
+bool QtFrameBackend::hasNativeHitTest(void) const {
+	return false;
+}
+
+QRect QtFrameBackend::frameGeometry(void) const {
+	return mWindow->frameGeometry();
+}
+
+void QtFrameBackend::updateFrame(bool frameRemoved) {
+	setWindowFlag(Qt::FramelessWindowHint, frameRemoved);
+}
+
+void QtFrameBackend::updateMargins(const QMargins&) {
+	// No compositor frame to extend
+}
+
+bool QtFrameBackend::startSystemMove(void) {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+	if (mWindow->windowHandle() != nullptr)
+		return mWindow->windowHandle()->startSystemMove();
+#endif
+	return false;
+}
+
+bool QtFrameBackend::startSystemResize(Qt::Edges edges) {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+	if (mWindow->windowHandle() != nullptr)
+		return mWindow->windowHandle()->startSystemResize(edges);
+#else
+	Q_UNUSED(edges);
+#endif
+	return false;
+}
+
+bool QtFrameBackend::hasSystemMenu(void) const {
+	return mWindow->windowFlags() & Qt::WindowSystemMenuHint;
+}
+
+void QtFrameBackend::setSystemMenu(bool visible) {
+	setWindowFlag(Qt::WindowSystemMenuHint, visible);
+}
+
+void QtFrameBackend::setResizable(bool resizable) {
+	if (resizable) {
+		mWindow->setMinimumSize(0, 0);
+		mWindow->setMaximumSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
+	}
+	else {
+		mWindow->setFixedSize(mWindow->size());
+	}
+}
+
+void QtFrameBackend::setBlurBehind(bool) {
+	// Not supported by Qt
+}
+
+void QtFrameBackend::setWindowFlag(Qt::WindowType flag, bool on) {
+	Qt::WindowFlags flags = mWindow->windowFlags();
+	if (bool(flags & flag) == on)
+		return;
+
+	// Changing the flags recreates the native window, which hides it
+	bool visible = mWindow->isVisible();
+	mWindow->setWindowFlags(on ? flags | flag : flags & ~flag);
+	if (visible)
+		mWindow->show();
+}
+
+}
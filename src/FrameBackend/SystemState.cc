@@ -0,0 +1,94 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "FrameBackend/SystemState.hh"
+#include "FrameBackend/Win32.hh"
+
+#include <atomic>
+
+namespace CustomWindow {
+
+namespace {
+
+enum StateBits {
+	StateValid = 0x1,
+	StateComposition = 0x2,
+	StateTheme = 0x4
+};
+
+class PlatformStateProvider : public SystemStateProvider {
+public:
+	bool queryCompositionEnabled(void) override {
+#ifdef Q_OS_WIN
+		return Win32FrameBackend::queryCompositionEnabled();
+#else
+		return false;
+#endif
+	}
+
+	bool queryThemeActive(void) override {
+#ifdef Q_OS_WIN
+		return Win32FrameBackend::queryThemeActive();
+#else
+		return false;
+#endif
+	}
+};
+
+PlatformStateProvider gPlatformProvider;
+std::atomic<SystemStateProvider*> gProvider(&gPlatformProvider);
+std::atomic<int> gState(0);
+
+int loadState(void) {
+	int state = gState.load(std::memory_order_acquire);
+	if (!(state & StateValid)) {
+		SystemState::refresh();
+		state = gState.load(std::memory_order_acquire);
+	}
+	return state;
+}
+
+}
+
+SystemStateProvider::~SystemStateProvider() {
+}
+
+bool SystemState::isCompositionEnabled(void) {
+	return loadState() & StateComposition;
+}
+
+bool SystemState::isThemeActive(void) {
+	return loadState() & StateTheme;
+}
+
+void SystemState::refresh(void) {
+	SystemStateProvider* provider = gProvider.load(std::memory_order_acquire);
+
+	int state = StateValid;
+	if (provider->queryCompositionEnabled())
+		state |= StateComposition;
+	if (provider->queryThemeActive())
+		state |= StateTheme;
+
+	gState.store(state, std::memory_order_release);
+}
+
+void SystemState::setProvider(SystemStateProvider* provider) {
+	gProvider.store(provider != nullptr ? provider : &gPlatformProvider, std::memory_order_release);
+	refresh();
+}
+
+}
@@ -0,0 +1,147 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// Based on Adaedra QDwm
+// Copyright (C) 2011 Adaedra
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "FrameBackend/Win32.hh"
+#include "FrameBackend/Composition.hh"
+
+#ifdef Q_OS_WIN
+    #include <QSysInfo>
+    #include <QWidget>
+
+static const long ncHitZone[] = {
+	HTNOWHERE, HTCLIENT, HTCAPTION,
+	HTLEFT, HTRIGHT, HTTOP, HTTOPLEFT, HTTOPRIGHT,
+	HTBOTTOM, HTBOTTOMLEFT, HTBOTTOMRIGHT
+};
+
+namespace CustomWindow {
+
+Win32FrameBackend::Win32FrameBackend(QWidget* window) : FrameBackend(window) {
+}
+
+bool Win32FrameBackend::queryCompositionEnabled(void) {
+	BOOL isDwmEnabled;
+	HRESULT hr;
+
+	if (QSysInfo::windowsVersion() < QSysInfo::WV_VISTA)
+		return false;
+
+	hr = DwmIsCompositionEnabled(&isDwmEnabled);
+	if (hr < 0)
+		return false;
+	return isDwmEnabled == TRUE;
+}
+
+bool Win32FrameBackend::queryThemeActive(void) {
+	if (QSysInfo::windowsVersion() < QSysInfo::WV_XP)
+		return (false);
+
+	return IsThemeActive() == TRUE;
+}
+
+long Win32FrameBackend::toNative(HitZone zone) {
+	return ncHitZone[zone];
+}
+
+bool Win32FrameBackend::hasNativeHitTest(void) const {
+	return true;
+}
+
+QRect Win32FrameBackend::frameGeometry(void) const {
+	RECT rcWin;
+	GetWindowRect(handle(), &rcWin);
+
+	return QRect(rcWin.left, rcWin.top, rcWin.right - rcWin.left, rcWin.bottom - rcWin.top);
+}
+
+void Win32FrameBackend::updateFrame(bool) {
+	HWND hWnd = handle();
+
+	RECT rcClient;
+	GetWindowRect(hWnd, &rcClient);
+
+	SetWindowPos(hWnd, nullptr, rcClient.left, rcClient.top,
+		rcClient.right - rcClient.left,
+		rcClient.bottom - rcClient.top, SWP_FRAMECHANGED);
+}
+
+void Win32FrameBackend::updateMargins(const QMargins& margins) {
+	MARGINS mar;
+	mar.cxLeftWidth = margins.left();
+	mar.cxRightWidth = margins.right();
+	mar.cyBottomHeight = margins.bottom();
+	mar.cyTopHeight = margins.top();
+
+	DwmExtendFrameIntoClientArea(handle(), &mar);
+}
+
+bool Win32FrameBackend::startSystemMove(void) {
+	ReleaseCapture();
+	SendMessage(handle(), WM_NCLBUTTONDOWN, HTCAPTION, 0);
+	return true;
+}
+
+bool Win32FrameBackend::startSystemResize(Qt::Edges edges) {
+	HitZone zone = HitNowhere;
+	if (edges == Qt::LeftEdge) zone = HitLeft;
+	else if (edges == Qt::RightEdge) zone = HitRight;
+	else if (edges == Qt::TopEdge) zone = HitTop;
+	else if (edges == Qt::BottomEdge) zone = HitBottom;
+	else if (edges == (Qt::TopEdge | Qt::LeftEdge)) zone = HitTopLeft;
+	else if (edges == (Qt::TopEdge | Qt::RightEdge)) zone = HitTopRight;
+	else if (edges == (Qt::BottomEdge | Qt::LeftEdge)) zone = HitBottomLeft;
+	else if (edges == (Qt::BottomEdge | Qt::RightEdge)) zone = HitBottomRight;
+	else return false;
+
+	ReleaseCapture();
+	SendMessage(handle(), WM_NCLBUTTONDOWN, toNative(zone), 0);
+	return true;
+}
+
+bool Win32FrameBackend::hasSystemMenu(void) const {
+	return GetWindowLong(handle(), GWL_STYLE) & WS_SYSMENU;
+}
+
+void Win32FrameBackend::setSystemMenu(bool visible) {
+	if (visible)
+		SetWindowLong(handle(), GWL_STYLE, GetWindowLong(handle(), GWL_STYLE) | WS_SYSMENU);
+	else
+		SetWindowLong(handle(), GWL_STYLE, GetWindowLong(handle(), GWL_STYLE) & ~WS_SYSMENU);
+}
+
+void Win32FrameBackend::setResizable(bool resizable) {
+	if (!resizable)
+		SetWindowLong(handle(), GWL_STYLE, GetWindowLong(handle(), GWL_STYLE) | WS_THICKFRAME | WS_OVERLAPPED);
+	else
+		SetWindowLong(handle(), GWL_STYLE, GetWindowLong(handle(), GWL_STYLE) & ~(WS_THICKFRAME | WS_OVERLAPPED));
+}
+
+void Win32FrameBackend::setBlurBehind(bool enabled) {
+	AccentPolicy policy;
+	policy.state = enabled ? AccentBlurBehind : AccentDisabled;
+	Composition::setAccent(mWindow->winId(), policy);
+}
+
+HWND Win32FrameBackend::handle(void) const {
+	return reinterpret_cast<HWND>(mWindow->winId());
+}
+
+}
+
+#endif
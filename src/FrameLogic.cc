@@ -0,0 +1,157 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "FrameLogic.hh"
+
+static const CustomWindow::HitZone ncHitZone[3][4] = {
+	{CustomWindow::HitTopLeft, CustomWindow::HitLeft, CustomWindow::HitLeft, CustomWindow::HitBottomLeft},
+	{CustomWindow::HitTop, CustomWindow::HitCaption, CustomWindow::HitNowhere, CustomWindow::HitBottom},
+	{CustomWindow::HitTopRight, CustomWindow::HitRight, CustomWindow::HitRight, CustomWindow::HitBottomRight}
+};
+
+namespace CustomWindow {
+
+namespace FrameLogic {
+
+QRect clientGeometry(const QSize& size, const QMargins& margins, int border, int titleBar) {
+	return QRect(margins.left() + border, margins.top() + border + titleBar,
+		size.width() - margins.left() - margins.right() - 2 * border,
+		size.height() - margins.top() - margins.bottom() - 2 * border - titleBar);
+}
+
+QMargins layoutMargins(const QSize& size, const QRect& client, const QMargins& extra) {
+	return QMargins(client.left() + extra.left(),
+		client.top() + extra.top(),
+		(size.width() - client.left() - client.width()) + extra.right(),
+		(size.height() - client.top() - client.height()) + extra.bottom());
+}
+
+HitZone hitZone(const QPoint& pos, const QSize& frame, int border, int titleBar) {
+	int xPos = 1;
+	int yPos = 2;
+
+	if (pos.y() >= 0 && pos.y() <= border)
+		yPos = 0;
+	else if (pos.y() >= border && pos.y() <= border + titleBar)
+		yPos = 1;
+	else if (pos.y() >= frame.height() - border && pos.y() < frame.height())
+		yPos = 3;
+
+	if (pos.x() >= 0 && pos.x() < border)
+		xPos = 0;
+	else if (pos.x() >= frame.width() - border && pos.x() < frame.width())
+		xPos = 2;
+
+	return ncHitZone[xPos][yPos];
+}
+
+Qt::Edges resizeEdges(HitZone zone) {
+	switch (zone) {
+	case HitLeft: return Qt::LeftEdge;
+	case HitRight: return Qt::RightEdge;
+	case HitTop: return Qt::TopEdge;
+	case HitBottom: return Qt::BottomEdge;
+	case HitTopLeft: return Qt::TopEdge | Qt::LeftEdge;
+	case HitTopRight: return Qt::TopEdge | Qt::RightEdge;
+	case HitBottomLeft: return Qt::BottomEdge | Qt::LeftEdge;
+	case HitBottomRight: return Qt::BottomEdge | Qt::RightEdge;
+	default: return Qt::Edges();
+	}
+}
+
+Qt::CursorShape cursorShape(HitZone zone) {
+	switch (zone) {
+	case HitLeft:
+	case HitRight:
+		return Qt::SizeHorCursor;
+	case HitTop:
+	case HitBottom:
+		return Qt::SizeVerCursor;
+	case HitTopLeft:
+	case HitBottomRight:
+		return Qt::SizeFDiagCursor;
+	case HitTopRight:
+	case HitBottomLeft:
+		return Qt::SizeBDiagCursor;
+	default:
+		return Qt::ArrowCursor;
+	}
+}
+
+}
+
+void TitleBarControls::setButtons(const Buttons& buttons) {
+	mButtons = buttons;
+}
+
+const TitleBarControls::Buttons& TitleBarControls::buttons(void) const {
+	return mButtons;
+}
+
+bool TitleBarControls::move(const QPoint& pos, bool maximized) {
+	// Maximized windows show the normal button at the place of the max button
+	if (mButtons.close.contains(pos))
+		return setHover(QStyle::SC_TitleBarCloseButton, QStyle::State_MouseOver);
+	else if (mButtons.max.contains(pos) && !maximized)
+		return setHover(QStyle::SC_TitleBarMaxButton, QStyle::State_MouseOver);
+	else if (mButtons.min.contains(pos))
+		return setHover(QStyle::SC_TitleBarMinButton, QStyle::State_MouseOver);
+	else if (mButtons.max.contains(pos) && maximized)
+		return setHover(QStyle::SC_TitleBarNormalButton, QStyle::State_MouseOver);
+
+	return setHover(QStyle::SC_None, QStyle::State_None);
+}
+
+bool TitleBarControls::press(void) {
+	if (mHover == QStyle::SC_None)
+		return false;
+
+	mState = QStyle::State_Sunken;
+	return true;
+}
+
+QStyle::SubControl TitleBarControls::release(void) {
+	if (mState != QStyle::State_Sunken)
+		return QStyle::SC_None;
+
+	mState = QStyle::State_MouseOver;
+	return mHover;
+}
+
+void TitleBarControls::reset(void) {
+	mHover = QStyle::SC_None;
+	mState = QStyle::State_None;
+}
+
+QStyle::SubControl TitleBarControls::hover(void) const {
+	return mHover;
+}
+
+QStyle::State TitleBarControls::state(void) const {
+	return mState;
+}
+
+bool TitleBarControls::setHover(QStyle::SubControl hover, QStyle::State state) {
+	// Same button: keep the current state (a pressed button stays pressed)
+	if (mHover == hover)
+		return false;
+
+	mHover = hover;
+	mState = state;
+	return true;
+}
+
+}
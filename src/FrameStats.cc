@@ -0,0 +1,240 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "FrameStats.hh"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QSaveFile>
+#include <QTimer>
+
+#include <algorithm>
+#include <vector>
+
+namespace CustomWindow {
+
+static QMutex gRegistryMutex;
+static std::vector<FrameStats*> gRegistry;
+
+static QTimer* gDumpTimer = nullptr;
+static QString gDumpFile;
+
+static int bucketOf(quint64 ns) {
+	int index = 0;
+	while (ns > 1 && index < LatencyHistogram::Buckets - 1) {
+		ns >>= 1;
+		index++;
+	}
+	return index;
+}
+
+LatencyHistogram::LatencyHistogram(void) {
+	reset();
+}
+
+void LatencyHistogram::record(quint64 ns) {
+	mBuckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+	mCount.fetch_add(1, std::memory_order_relaxed);
+	mTotal.fetch_add(ns, std::memory_order_relaxed);
+
+	quint64 max = mMax.load(std::memory_order_relaxed);
+	while (ns > max && !mMax.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+		;
+}
+
+void LatencyHistogram::reset(void) {
+	for (std::atomic<quint64>& bucket : mBuckets)
+		bucket.store(0, std::memory_order_relaxed);
+	mCount.store(0, std::memory_order_relaxed);
+	mTotal.store(0, std::memory_order_relaxed);
+	mMax.store(0, std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::count(void) const {
+	return mCount.load(std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::total(void) const {
+	return mTotal.load(std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::max(void) const {
+	return mMax.load(std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::bucket(int index) const {
+	return mBuckets[index].load(std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::percentile(double p) const {
+	quint64 samples = 0;
+	for (int i = 0; i < Buckets; i++)
+		samples += bucket(i);
+	if (samples == 0)
+		return 0;
+
+	quint64 target = quint64(p * samples);
+	quint64 seen = 0;
+	for (int i = 0; i < Buckets; i++) {
+		seen += bucket(i);
+		if (seen > target)
+			return (quint64(2) << i) - 1;
+	}
+	return max();
+}
+
+QJsonObject LatencyHistogram::toJson(void) const {
+	QJsonArray buckets;
+	int last = Buckets - 1;
+	while (last > 0 && bucket(last) == 0)
+		last--;
+	for (int i = 0; i <= last; i++)
+		buckets.append(double(bucket(i)));
+
+	QJsonObject ret;
+	ret["count"] = double(count());
+	ret["total_ns"] = double(total());
+	ret["max_ns"] = double(max());
+	ret["p50_ns"] = double(percentile(0.50));
+	ret["p99_ns"] = double(percentile(0.99));
+	ret["log2_buckets"] = buckets;
+	return ret;
+}
+
+FrameStats::FrameStats(const QString& name) : mName(name) {
+	for (std::atomic<quint64>& message : mMessages)
+		message.store(0, std::memory_order_relaxed);
+
+	QMutexLocker lock(&gRegistryMutex);
+	gRegistry.push_back(this);
+}
+
+FrameStats::~FrameStats() {
+	QMutexLocker lock(&gRegistryMutex);
+	gRegistry.erase(std::find(gRegistry.begin(), gRegistry.end(), this));
+}
+
+void FrameStats::setName(const QString& name) {
+	mName = name;
+}
+
+QString FrameStats::name(void) const {
+	return mName;
+}
+
+LatencyHistogram& FrameStats::histogram(FrameProbe probe) {
+	return mHistograms[probe];
+}
+
+const LatencyHistogram& FrameStats::histogram(FrameProbe probe) const {
+	return mHistograms[probe];
+}
+
+void FrameStats::countMessage(unsigned int message) {
+	mMessages[qMin(message, MessageCount)].fetch_add(1, std::memory_order_relaxed);
+}
+
+quint64 FrameStats::messageCount(unsigned int message) const {
+	return mMessages[qMin(message, MessageCount)].load(std::memory_order_relaxed);
+}
+
+void FrameStats::reset(void) {
+	for (LatencyHistogram& histogram : mHistograms)
+		histogram.reset();
+	for (std::atomic<quint64>& message : mMessages)
+		message.store(0, std::memory_order_relaxed);
+}
+
+QJsonObject FrameStats::toJson(void) const {
+	QJsonObject probes;
+	for (int i = 0; i < ProbeCount; i++)
+		probes[probeName(FrameProbe(i))] = mHistograms[i].toJson();
+
+	// Keyed by hexadecimal message number, WM_USER and above are together
+	QJsonObject messages;
+	for (unsigned int i = 0; i <= MessageCount; i++) {
+		quint64 count = messageCount(i);
+		if (count == 0)
+			continue;
+		QString key = i == MessageCount ? QString("user") : QString("0x%1").arg(i, 4, 16, QChar('0'));
+		messages[key] = double(count);
+	}
+
+	QJsonObject ret;
+	ret["name"] = mName;
+	ret["probes"] = probes;
+	ret["messages"] = messages;
+	return ret;
+}
+
+const char* FrameStats::probeName(FrameProbe probe) {
+	switch (probe) {
+	case ProbePaintEvent: return "paintEvent";
+	case ProbePaintWinFrame: return "paintWinFrame";
+	case ProbeNativeEvent: return "nativeEvent";
+	case ProbeHitTest: return "hitTest";
+	default: return "unknown";
+	}
+}
+
+QJsonObject FrameStats::dumpAll(void) {
+	QJsonArray windows;
+	{
+		QMutexLocker lock(&gRegistryMutex);
+		for (const FrameStats* stats : gRegistry)
+			windows.append(stats->toJson());
+	}
+
+	QJsonObject ret;
+	ret["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+	ret["windows"] = windows;
+	return ret;
+}
+
+void FrameStats::setPeriodicDump(const QString& file, int msec) {
+	if (msec <= 0 || file.isEmpty()) {
+		delete gDumpTimer;
+		gDumpTimer = nullptr;
+		return;
+	}
+
+	gDumpFile = file;
+	if (gDumpTimer == nullptr) {
+		gDumpTimer = new QTimer(QCoreApplication::instance());
+		QObject::connect(gDumpTimer, &QTimer::timeout, []() {
+			QSaveFile out(gDumpFile);
+			if (!out.open(QIODevice::WriteOnly))
+				return;
+			out.write(QJsonDocument(dumpAll()).toJson());
+			out.commit();
+		});
+	}
+	gDumpTimer->start(msec);
+}
+
+FrameStats::Scope::Scope(FrameStats& stats, FrameProbe probe)
+	: mHistogram(stats.histogram(probe)), mStart(std::chrono::steady_clock::now()) {
+}
+
+FrameStats::Scope::~Scope() {
+	auto elapsed = std::chrono::steady_clock::now() - mStart;
+	mHistogram.record(quint64(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+}
@@ -0,0 +1,402 @@
+#include <RibbonDefinition.hh>
+#include <RibbonWindow.hh>
+#include <StartupTrace.hh>
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QtEndian>
+
+#include <cstring>
+#include <vector>
+
+namespace RibbonUI {
+
+// Records are read in place from the mapping, the format is the memory layout of a little endian host
+struct RibbonDefinition::Header {
+    quint32 magic;
+    quint32 version;
+    quint32 fileSize;
+    quint32 tabCount;
+    quint32 groupCount;
+    quint32 commandCount;
+    quint32 stringCount;
+    // UTF-16 code units of the string data
+    quint32 stringUnits;
+};
+
+struct RibbonDefinition::TabRecord {
+    quint32 title;
+    quint32 firstGroup;
+    quint32 groupCount;
+};
+
+struct RibbonDefinition::GroupRecord {
+    quint32 title;
+    quint32 firstCommand;
+    quint32 commandCount;
+};
+
+struct RibbonDefinition::CommandRecord {
+    quint32 id;
+    quint32 label;
+    // Index of the icon name, 0 (the empty string) for none
+    quint32 icon;
+    quint32 size;
+};
+
+// Offset and length in UTF-16 code units in the string data
+struct RibbonDefinition::StringRecord {
+    quint32 offset;
+    quint32 length;
+};
+
+template <typename T>
+static qint64 sectionSize(quint32 count)
+{
+    return qint64(sizeof(T)) * count;
+}
+
+RibbonDefinition::RibbonDefinition(void) : mData(nullptr), mSize(0)
+{
+}
+
+RibbonDefinition::~RibbonDefinition()
+{
+    close();
+}
+
+bool RibbonDefinition::open(const QString &path)
+{
+    STARTUP_SCOPE("RibbonDefinition::open");
+    close();
+
+    std::unique_ptr<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly)) {
+        mError = file->errorString();
+        return false;
+    }
+    const uchar* data = file->map(0, file->size());
+    if (data == nullptr) {
+        mError = file->errorString();
+        return false;
+    }
+
+    mFile = std::move(file);
+    mData = data;
+    mSize = mFile->size();
+    if (!validate()) {
+        QString error = mError;
+        close();
+        mError = error;
+        return false;
+    }
+    return true;
+}
+
+bool RibbonDefinition::open(const uchar* data, qint64 size)
+{
+    close();
+    mData = data;
+    mSize = size;
+    if (!validate()) {
+        QString error = mError;
+        close();
+        mError = error;
+        return false;
+    }
+    return true;
+}
+
+void RibbonDefinition::close(void)
+{
+    // Unmapped with the file
+    mFile.reset();
+    mData = nullptr;
+    mSize = 0;
+    mError.clear();
+}
+
+bool RibbonDefinition::isOpen(void) const
+{
+    return mData != nullptr;
+}
+
+QString RibbonDefinition::errorString(void) const
+{
+    return mError;
+}
+
+int RibbonDefinition::tabCount(void) const
+{
+    return isOpen() ? int(header().tabCount) : 0;
+}
+
+QString RibbonDefinition::tabTitle(int tab) const
+{
+    return string(tabs()[tab].title);
+}
+
+int RibbonDefinition::groupCount(int tab) const
+{
+    return int(tabs()[tab].groupCount);
+}
+
+int RibbonDefinition::commandCount(void) const
+{
+    return isOpen() ? int(header().commandCount) : 0;
+}
+
+QString RibbonDefinition::commandId(int command) const
+{
+    return string(commands()[command].id);
+}
+
+QString RibbonDefinition::commandLabel(int command) const
+{
+    return string(commands()[command].label);
+}
+
+QString RibbonDefinition::commandIcon(int command) const
+{
+    return string(commands()[command].icon);
+}
+
+ControlSize RibbonDefinition::commandSize(int command) const
+{
+    return ControlSize(commands()[command].size);
+}
+
+void RibbonDefinition::build(int tab, Tab &out, const IconLoader &icons) const
+{
+    const TabRecord &record = tabs()[tab];
+    out.setName(string(record.title));
+
+    for (quint32 g = record.firstGroup; g < record.firstGroup + record.groupCount; g++) {
+        const GroupRecord &group = groups()[g];
+        GroupId id = out.addGroup(string(group.title));
+
+        for (quint32 c = group.firstCommand; c < group.firstCommand + group.commandCount; c++) {
+            const CommandRecord &command = commands()[c];
+            QPixmap icon = command.icon != 0 && icons ? icons(string(command.icon)) : QPixmap();
+            ControlId control = out.addControl(id, string(command.label), icon, ControlSize(command.size));
+            out.setCommand(control, CommandId(c));
+        }
+    }
+}
+
+void RibbonDefinition::install(Window &window, const IconLoader &icons) const
+{
+    for (int t = 0; t < tabCount(); t++)
+        window.addTab(tabTitle(t), [this, t, icons](Tab &tab) { build(t, tab, icons); });
+}
+
+bool RibbonDefinition::validate(void)
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    mError = "ribbon definitions are only readable on little endian hosts";
+    return false;
+#endif
+    if (mSize < qint64(sizeof(Header)) || (quintptr(mData) & 3) != 0) {
+        mError = "truncated or misaligned data";
+        return false;
+    }
+
+    const Header &h = header();
+    if (h.magic != Magic || h.version != Version) {
+        mError = "not a ribbon definition (or unsupported version)";
+        return false;
+    }
+
+    qint64 expected = qint64(sizeof(Header)) + sectionSize<TabRecord>(h.tabCount) + sectionSize<GroupRecord>(h.groupCount)
+        + sectionSize<CommandRecord>(h.commandCount) + sectionSize<StringRecord>(h.stringCount) + 2 * qint64(h.stringUnits);
+    if (h.fileSize != mSize || mSize < expected || h.stringCount == 0) {
+        mError = "section sizes don't match the data size";
+        return false;
+    }
+
+    // Every reference is checked once here, the accessors trust the data afterwards
+    for (quint32 i = 0; i < h.stringCount; i++) {
+        const StringRecord &s = strings()[i];
+        if (qint64(s.offset) + s.length > h.stringUnits) {
+            mError = QString("string %1 out of the string data").arg(i);
+            return false;
+        }
+    }
+    for (quint32 i = 0; i < h.tabCount; i++) {
+        const TabRecord &t = tabs()[i];
+        if (t.title >= h.stringCount || qint64(t.firstGroup) + t.groupCount > h.groupCount) {
+            mError = QString("tab %1 has invalid references").arg(i);
+            return false;
+        }
+    }
+    for (quint32 i = 0; i < h.groupCount; i++) {
+        const GroupRecord &g = groups()[i];
+        if (g.title >= h.stringCount || qint64(g.firstCommand) + g.commandCount > h.commandCount) {
+            mError = QString("group %1 has invalid references").arg(i);
+            return false;
+        }
+    }
+    for (quint32 i = 0; i < h.commandCount; i++) {
+        const CommandRecord &c = commands()[i];
+        if (c.id >= h.stringCount || c.label >= h.stringCount || c.icon >= h.stringCount || c.size > SmallControl) {
+            mError = QString("command %1 has invalid references").arg(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+QString RibbonDefinition::string(quint32 index) const
+{
+    const StringRecord &s = strings()[index];
+    const QChar* data = reinterpret_cast<const QChar*>(reinterpret_cast<const uchar*>(strings() + header().stringCount)) + s.offset;
+    // Deep copy: the strings end up in tabs, windows and caches which outlive the mapping
+    return QString(data, int(s.length));
+}
+
+const RibbonDefinition::Header &RibbonDefinition::header(void) const
+{
+    return *reinterpret_cast<const Header*>(mData);
+}
+
+const RibbonDefinition::TabRecord* RibbonDefinition::tabs(void) const
+{
+    return reinterpret_cast<const TabRecord*>(mData + sizeof(Header));
+}
+
+const RibbonDefinition::GroupRecord* RibbonDefinition::groups(void) const
+{
+    return reinterpret_cast<const GroupRecord*>(tabs() + header().tabCount);
+}
+
+const RibbonDefinition::CommandRecord* RibbonDefinition::commands(void) const
+{
+    return reinterpret_cast<const CommandRecord*>(groups() + header().groupCount);
+}
+
+const RibbonDefinition::StringRecord* RibbonDefinition::strings(void) const
+{
+    return reinterpret_cast<const StringRecord*>(commands() + header().commandCount);
+}
+
+namespace {
+
+// Strings are stored once, index 0 is the empty string
+class StringTable {
+public:
+    StringTable(void) { add(QString()); }
+
+    quint32 add(const QString &string)
+    {
+        auto it = mIndex.constFind(string);
+        if (it != mIndex.constEnd())
+            return it.value();
+
+        quint32 index = quint32(mStrings.size());
+        mIndex.insert(string, index);
+        mStrings.push_back(string);
+        return index;
+    }
+
+    const std::vector<QString> &strings(void) const { return mStrings; }
+
+private:
+    QHash<QString, quint32> mIndex;
+    std::vector<QString> mStrings;
+};
+
+}
+
+template <typename T>
+static void append(QByteArray &out, const T* records, size_t count)
+{
+    out.append(reinterpret_cast<const char*>(records), int(sizeof(T) * count));
+}
+
+QByteArray RibbonDefinition::compile(const QJsonDocument &source, QString* error)
+{
+    auto fail = [error](const QString &reason) {
+        if (error != nullptr)
+            *error = reason;
+        return QByteArray();
+    };
+
+    if (!source.isObject() || !source.object().value("tabs").isArray())
+        return fail("the source must be an object with a \"tabs\" array");
+
+    StringTable table;
+    std::vector<TabRecord> tabs;
+    std::vector<GroupRecord> groups;
+    std::vector<CommandRecord> commands;
+
+    const QJsonArray tabArray = source.object().value("tabs").toArray();
+    for (int t = 0; t < tabArray.size(); t++) {
+        const QJsonObject tab = tabArray[t].toObject();
+        const QJsonArray groupArray = tab.value("groups").toArray();
+        tabs.push_back({table.add(tab.value("title").toString()), quint32(groups.size()), quint32(groupArray.size())});
+
+        for (int g = 0; g < groupArray.size(); g++) {
+            const QJsonObject group = groupArray[g].toObject();
+            const QJsonArray commandArray = group.value("commands").toArray();
+            groups.push_back({table.add(group.value("title").toString()), quint32(commands.size()), quint32(commandArray.size())});
+
+            for (int c = 0; c < commandArray.size(); c++) {
+                const QJsonObject command = commandArray[c].toObject();
+                const QString size = command.value("size").toString("large");
+                ControlSize controlSize;
+                if (size == "large")
+                    controlSize = LargeControl;
+                else if (size == "medium")
+                    controlSize = MediumControl;
+                else if (size == "small")
+                    controlSize = SmallControl;
+                else
+                    return fail(QString("tab %1, group %2, command %3: unknown size \"%4\"").arg(t).arg(g).arg(c).arg(size));
+
+                QString label = command.value("label").toString();
+                if (label.isEmpty())
+                    return fail(QString("tab %1, group %2, command %3: missing label").arg(t).arg(g).arg(c));
+
+                commands.push_back({table.add(command.value("id").toString()), table.add(label),
+                                    table.add(command.value("icon").toString()), quint32(controlSize)});
+            }
+        }
+    }
+
+    std::vector<StringRecord> strings;
+    QByteArray data;
+    for (const QString &string : table.strings()) {
+        strings.push_back({quint32(data.size() / 2), quint32(string.size())});
+        for (QChar ch : string) {
+            quint16 unit = qToLittleEndian(ch.unicode());
+            data.append(reinterpret_cast<const char*>(&unit), 2);
+        }
+    }
+    // Keep the file size a multiple of 4
+    if (data.size() % 4 != 0)
+        data.append(2, '\0');
+
+    Header header;
+    header.magic = Magic;
+    header.version = Version;
+    header.tabCount = quint32(tabs.size());
+    header.groupCount = quint32(groups.size());
+    header.commandCount = quint32(commands.size());
+    header.stringCount = quint32(strings.size());
+    header.stringUnits = quint32(data.size() / 2);
+    header.fileSize = quint32(sizeof(Header) + sizeof(TabRecord) * tabs.size() + sizeof(GroupRecord) * groups.size()
+                              + sizeof(CommandRecord) * commands.size() + sizeof(StringRecord) * strings.size() + data.size());
+
+    QByteArray out;
+    out.reserve(int(header.fileSize));
+    append(out, &header, 1);
+    append(out, tabs.data(), tabs.size());
+    append(out, groups.data(), groups.size());
+    append(out, commands.data(), commands.size());
+    append(out, strings.data(), strings.size());
+    out.append(data);
+    return out;
+}
+
+}
@@ -0,0 +1,231 @@
+#include <RibbonStyle/AsyncRenderer.hh>
+#include <RibbonStyle/LabelCache.hh>
+#include <RibbonTab.hh>
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QRunnable>
+#include <QThread>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+// Posted to the renderer when the first result of a batch is available
+static const QEvent::Type ResultsReady = QEvent::Type(QEvent::User + 0x5242);
+
+class AsyncRenderer::Job : public QRunnable {
+public:
+    Job(AsyncRenderer* renderer, RibbonStyle* style, const PixmapCache::Key &key, const QImage &icon, quint64 revision)
+        : mRenderer(renderer), mStyle(style), mKey(key), mIcon(icon), mRevision(revision)
+    {
+    }
+
+    void run() override
+    {
+        QImage image;
+        if (mKey.kind == PixmapCache::Tab)
+            image = mStyle->drawTabImage(mKey.minsize, mKey.state, mKey.name, mIcon, mKey.maxsize, mKey.dpr);
+        else
+            image = mStyle->drawButtonImage(mKey.minsize, mKey.state, mKey.name, mIcon, mKey.maxsize, mKey.dpr);
+        mRenderer->finished({mKey, image, mRevision});
+    }
+
+private:
+    AsyncRenderer* mRenderer;
+    RibbonStyle* mStyle;
+    PixmapCache::Key mKey;
+    QImage mIcon;
+    quint64 mRevision;
+};
+
+AsyncRenderer::AsyncRenderer(CachedStyle* style, QObject* parent)
+    : QObject(parent), mStyle(style), mQueueDepth(256)
+{
+    mPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    LabelCache::watchFontChanges();
+}
+
+AsyncRenderer::~AsyncRenderer()
+{
+    // Workers hold a pointer to us; undelivered results are dropped
+    mPool.waitForDone();
+}
+
+void AsyncRenderer::setWorkerCount(int count)
+{
+    mPool.setMaxThreadCount(qMax(1, count));
+}
+
+int AsyncRenderer::workerCount(void) const
+{
+    return mPool.maxThreadCount();
+}
+
+void AsyncRenderer::setQueueDepth(int depth)
+{
+    mQueueDepth = depth;
+}
+
+int AsyncRenderer::queueDepth(void) const
+{
+    return mQueueDepth;
+}
+
+bool AsyncRenderer::render(const RenderRequest &request, const Callback &callback)
+{
+    PixmapCache::Key key = makeKey(request);
+
+    if (mStyle->cache()->contains(key)) {
+        if (callback)
+            callback(drawSync(request));
+        return true;
+    }
+
+    auto pending = mPending.find(key);
+    if (pending != mPending.end()) {
+        if (callback)
+            pending.value().callbacks.push_back(callback);
+        return true;
+    }
+
+    if (!mStyle->style()->isThreadSafe()) {
+        mStats.submitted++;
+        mStats.completed++;
+        QPixmap pixmap = drawSync(request);
+        if (callback)
+            callback(pixmap);
+        return true;
+    }
+
+    if (mPending.size() >= mQueueDepth) {
+        mStats.rejected++;
+        return false;
+    }
+
+    Pending entry = {request, {}};
+    if (callback)
+        entry.callbacks.push_back(callback);
+    mPending.insert(key, entry);
+    mStats.submitted++;
+
+    // QPixmap can't be used by the workers
+    QImage icon = request.icon.isNull() ? QImage() : request.icon.toImage();
+    mPool.start(new Job(this, mStyle->style(), key, icon, mStyle->style()->revision()));
+    return true;
+}
+
+int AsyncRenderer::prerender(const Tab &tab)
+{
+    const ButtonState states[] = {NORMAL, HOVER, ACTIVE, DISABLED};
+
+    int accepted = 0;
+    for (ControlId id = 0; id < tab.controlCount(); id++) {
+        // Hidden, or in a collapsed group
+        if (tab.controlGeometry(id).isNull())
+            continue;
+
+        Tab::ControlRender render = Tab::controlRender(tab.displayedSize(id));
+        for (ButtonState state : states) {
+            RenderRequest request;
+            request.kind = render.button ? PixmapCache::Button : PixmapCache::Tab;
+            request.minsize = render.minsize;
+            request.state = state;
+            request.name = render.label ? tab.label(id) : QString();
+            request.icon = tab.icon(id);
+            if (this->render(request))
+                accepted++;
+        }
+    }
+    return accepted;
+}
+
+QPixmap AsyncRenderer::pixmap(const RenderRequest &request)
+{
+    if (mStyle->cache()->contains(makeKey(request)))
+        mStats.hits++;
+    else
+        mStats.fallbacks++;
+    return drawSync(request);
+}
+
+void AsyncRenderer::waitForDone(void)
+{
+    mPool.waitForDone();
+    deliver();
+}
+
+AsyncRendererStats AsyncRenderer::stats(void) const
+{
+    return mStats;
+}
+
+void AsyncRenderer::resetStats(void)
+{
+    mStats = AsyncRendererStats();
+}
+
+bool AsyncRenderer::event(QEvent* event)
+{
+    if (event->type() == ResultsReady) {
+        deliver();
+        return true;
+    }
+    return QObject::event(event);
+}
+
+PixmapCache::Key AsyncRenderer::makeKey(const RenderRequest &request) const
+{
+    qint64 icon = request.icon.isNull() ? 0 : request.icon.cacheKey();
+    return mStyle->makeKey(request.kind, request.minsize, request.state, request.name, icon, request.maxsize);
+}
+
+QPixmap AsyncRenderer::drawSync(const RenderRequest &request)
+{
+    if (request.kind == PixmapCache::Tab)
+        return mStyle->drawTab(request.minsize, request.state, request.name, request.icon, request.maxsize);
+    return mStyle->drawButton(request.minsize, request.state, request.name, request.icon, request.maxsize);
+}
+
+void AsyncRenderer::finished(const Result &result)
+{
+    QMutexLocker lock(&mMutex);
+    mResults.push_back(result);
+    // One event for all the results finished before the GUI thread gets to them
+    if (mResults.size() == 1)
+        QCoreApplication::postEvent(this, new QEvent(ResultsReady));
+}
+
+void AsyncRenderer::deliver(void)
+{
+    std::vector<Result> results;
+    {
+        QMutexLocker lock(&mMutex);
+        results.swap(mResults);
+    }
+
+    for (const Result &result : results) {
+        Pending pending = mPending.take(result.key);
+
+        QPixmap pixmap;
+        if (result.revision != mStyle->style()->revision()) {
+            // Rendered with old parameters: callbacks get a synchronous rendering with the new ones
+            mStats.stale++;
+            if (pending.callbacks.empty())
+                continue;
+            pixmap = drawSync(pending.request);
+        }
+        else {
+            pixmap = QPixmap::fromImage(result.image);
+            mStyle->cache()->insert(result.key, pixmap);
+            mStats.completed++;
+        }
+
+        for (const Callback &callback : pending.callbacks)
+            callback(pixmap);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,244 @@
+#include <RibbonStyle/Cache.hh>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+bool PixmapCache::Key::operator==(const Key &other) const
+{
+    return style == other.style && kind == other.kind && state == other.state
+        && minsize == other.minsize && maxsize == other.maxsize
+        && icon == other.icon && dpr == other.dpr && name == other.name;
+}
+
+uint qHash(const PixmapCache::Key &key, uint seed)
+{
+    uint h = qHash(key.style, seed);
+    h = h * 31 + (uint(key.kind) << 2 | uint(key.state));
+    h = h * 31 + uint(key.minsize.width()) * 65599u + uint(key.minsize.height());
+    h = h * 31 + uint(key.maxsize.width()) * 65599u + uint(key.maxsize.height());
+    h = h * 31 + qHash(key.icon, seed);
+    h = h * 31 + uint(qRound(key.dpr * 100));
+    return h ^ qHash(key.name, seed);
+}
+
+PixmapCache::PixmapCache(qint64 budget) : mBudget(budget)
+{
+}
+
+void PixmapCache::setBudget(qint64 bytes)
+{
+    mBudget = bytes;
+    trim(mBudget);
+}
+
+qint64 PixmapCache::budget(void) const
+{
+    return mBudget;
+}
+
+bool PixmapCache::find(const Key &key, QPixmap* pixmap)
+{
+    auto it = mIndex.constFind(key);
+    if (it == mIndex.constEnd()) {
+        mStats.misses++;
+        return false;
+    }
+
+    mEntries.splice(mEntries.begin(), mEntries, it.value());
+    *pixmap = it.value()->pixmap;
+    mStats.hits++;
+    return true;
+}
+
+bool PixmapCache::contains(const Key &key) const
+{
+    return mIndex.contains(key);
+}
+
+void PixmapCache::insert(const Key &key, const QPixmap &pixmap)
+{
+    qint64 bytes = pixmapBytes(pixmap);
+    if (bytes > mBudget)
+        return;
+
+    auto it = mIndex.find(key);
+    if (it != mIndex.end()) {
+        mStats.bytes -= it.value()->bytes;
+        mEntries.erase(it.value());
+        mIndex.erase(it);
+    }
+
+    trim(mBudget - bytes);
+
+    mEntries.push_front({key, pixmap, bytes});
+    mIndex.insert(key, mEntries.begin());
+    mStats.bytes += bytes;
+    mStats.entries = mIndex.size();
+}
+
+void PixmapCache::clear(void)
+{
+    mEntries.clear();
+    mIndex.clear();
+    mStats.bytes = 0;
+    mStats.entries = 0;
+}
+
+void PixmapCache::clear(const RibbonStyle* style)
+{
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (it->key.style == style) {
+            mStats.bytes -= it->bytes;
+            mIndex.remove(it->key);
+            it = mEntries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    mStats.entries = mIndex.size();
+}
+
+qint64 PixmapCache::bytes(const RibbonStyle* style) const
+{
+    qint64 ret = 0;
+    for (const Entry &entry : mEntries) {
+        if (entry.key.style == style)
+            ret += entry.bytes;
+    }
+    return ret;
+}
+
+PixmapCacheStats PixmapCache::stats(void) const
+{
+    return mStats;
+}
+
+void PixmapCache::resetStats(void)
+{
+    mStats.hits = 0;
+    mStats.misses = 0;
+    mStats.evictions = 0;
+}
+
+qint64 PixmapCache::pixmapBytes(const QPixmap &pixmap)
+{
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+void PixmapCache::trim(qint64 budget)
+{
+    while (!mEntries.empty() && mStats.bytes > budget) {
+        const Entry &last = mEntries.back();
+        mStats.bytes -= last.bytes;
+        mIndex.remove(last.key);
+        mEntries.pop_back();
+        mStats.evictions++;
+    }
+    mStats.entries = mIndex.size();
+}
+
+CachedStyle::CachedStyle(RibbonStyle* style, PixmapCache* cache)
+    : mStyle(style), mCache(cache), mOwnCache(cache == nullptr), mStyleRevision(style->revision())
+{
+    if (mOwnCache)
+        mCache = new PixmapCache();
+    setDevicePixelRatio(style->devicePixelRatio());
+}
+
+CachedStyle::~CachedStyle()
+{
+    if (mOwnCache)
+        delete mCache;
+}
+
+QPixmap CachedStyle::drawTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, QSize maxsize)
+{
+    return draw(PixmapCache::Tab, minsize, state, name, icon, maxsize);
+}
+
+QPixmap CachedStyle::drawButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, QSize maxsize)
+{
+    return draw(PixmapCache::Button, minsize, state, name, icon, maxsize);
+}
+
+QPixmap CachedStyle::drawTab(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize)
+{
+    return draw(PixmapCache::Tab, minsize, state, name, icon, maxsize);
+}
+
+QPixmap CachedStyle::drawButton(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize)
+{
+    return draw(PixmapCache::Button, minsize, state, name, icon, maxsize);
+}
+
+void CachedStyle::paintTab(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon)
+{
+    mStyle->paintTab(p, rect, state, name, icon);
+}
+
+void CachedStyle::paintButton(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon)
+{
+    mStyle->paintButton(p, rect, state, name, icon);
+}
+
+RibbonStyle* CachedStyle::style(void) const
+{
+    return mStyle;
+}
+
+PixmapCache* CachedStyle::cache(void) const
+{
+    return mCache;
+}
+
+QPixmap CachedStyle::draw(PixmapCache::Kind kind, QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, QSize maxsize)
+{
+    PixmapCache::Key key = makeKey(kind, minsize, state, name, icon.isNull() ? 0 : icon.cacheKey(), maxsize);
+    QPixmap ret;
+    if (mCache->find(key, &ret))
+        return ret;
+
+    mStyle->setDevicePixelRatio(devicePixelRatio());
+    if (kind == PixmapCache::Tab)
+        ret = mStyle->drawTab(minsize, state, name, icon, maxsize);
+    else
+        ret = mStyle->drawButton(minsize, state, name, icon, maxsize);
+
+    mCache->insert(key, ret);
+    return ret;
+}
+
+QPixmap CachedStyle::draw(PixmapCache::Kind kind, QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize)
+{
+    PixmapCache::Key key = makeKey(kind, minsize, state, name, icon.key, maxsize);
+    QPixmap ret;
+    if (mCache->find(key, &ret))
+        return ret;
+
+    mStyle->setDevicePixelRatio(devicePixelRatio());
+    if (kind == PixmapCache::Tab)
+        ret = mStyle->drawTab(minsize, state, name, icon, maxsize);
+    else
+        ret = mStyle->drawButton(minsize, state, name, icon, maxsize);
+
+    mCache->insert(key, ret);
+    return ret;
+}
+
+PixmapCache::Key CachedStyle::makeKey(PixmapCache::Kind kind, QSize minsize, ButtonState state, const QString &name, qint64 icon, QSize maxsize)
+{
+    // Colors or other parameters of the wrapped style changed: all our entries are stale
+    if (mStyle->revision() != mStyleRevision) {
+        mStyleRevision = mStyle->revision();
+        mCache->clear(mStyle);
+        invalidate();
+    }
+
+    return {mStyle, kind, state, minsize, maxsize, name, icon, devicePixelRatio()};
+}
+
+}
+
+}
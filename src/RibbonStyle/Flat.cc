@@ -0,0 +1,340 @@
+#include <RibbonStyle/Flat.hh>
+#include <RibbonStyle/LabelCache.hh>
+
+#include <QGuiApplication>
+#include <QPainter>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+static const int TabPadding = 12;
+static const int TabIconSize = 16;
+static const int ButtonPadding = 4;
+static const int ButtonIconSize = 32;
+static const int Spacing = 4;
+// Corners of the background templates, the centre pixel is stretched
+static const int TemplateMargin = 2;
+
+static QSize boundSize(QSize size, QSize minsize, QSize maxsize)
+{
+    size = size.expandedTo(minsize);
+    if (maxsize.isValid())
+        size = size.boundedTo(maxsize);
+    return size;
+}
+
+FlatStyle::FlatStyle(void) : mMainColor(43, 87, 154), mHightlightColor(62, 109, 181)
+{
+}
+
+QPixmap FlatStyle::drawTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, QSize maxsize)
+{
+    return renderTab(minsize, state, name, icon, QRectF(icon.rect()), maxsize);
+}
+
+QPixmap FlatStyle::drawButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, QSize maxsize)
+{
+    return renderButton(minsize, state, name, icon, QRectF(icon.rect()), maxsize);
+}
+
+QPixmap FlatStyle::drawTab(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize)
+{
+    // Drawn straight from the atlas sheet, no copy of the icon
+    QPixmap sheet = icon.isValid() ? icon.atlas->sheet(icon.sheet) : QPixmap();
+    return renderTab(minsize, state, name, sheet, IconAtlas::sourceRect(icon), maxsize);
+}
+
+QPixmap FlatStyle::drawButton(QSize minsize, ButtonState state, const QString &name, const IconHandle &icon, QSize maxsize)
+{
+    QPixmap sheet = icon.isValid() ? icon.atlas->sheet(icon.sheet) : QPixmap();
+    return renderButton(minsize, state, name, sheet, IconAtlas::sourceRect(icon), maxsize);
+}
+
+void FlatStyle::paintTab(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon)
+{
+    PaintContext context;
+    context.pixmap = &icon;
+    context.source = QRectF(icon.rect());
+    context.dpr = p.device()->devicePixelRatioF();
+
+    backgroundTemplate(state, context.dpr).draw(p, rect);
+    paintTabContent(p, rect, state, name, context);
+}
+
+void FlatStyle::paintButton(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const QPixmap &icon)
+{
+    PaintContext context;
+    context.pixmap = &icon;
+    context.source = QRectF(icon.rect());
+    context.dpr = p.device()->devicePixelRatioF();
+
+    backgroundTemplate(state, context.dpr).draw(p, rect);
+    paintButtonContent(p, rect, state, name, context);
+}
+
+bool FlatStyle::isThreadSafe(void) const
+{
+    return true;
+}
+
+QImage FlatStyle::drawTabImage(QSize minsize, ButtonState state, const QString &name, const QImage &icon, QSize maxsize, qreal dpr)
+{
+    PaintContext context;
+    context.image = &icon;
+    context.source = QRectF(icon.rect());
+    context.dpr = dpr;
+    context.staticText = false;
+
+    QSize size = tabSize(minsize, name, !icon.isNull(), maxsize);
+    QImage ret(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    ret.setDevicePixelRatio(dpr);
+    ret.fill(Qt::transparent);
+
+    QPainter p(&ret);
+    paintBackground(p, QRect(QPoint(0, 0), size), state);
+    paintTabContent(p, QRect(QPoint(0, 0), size), state, name, context);
+    p.end();
+
+    return ret;
+}
+
+QImage FlatStyle::drawButtonImage(QSize minsize, ButtonState state, const QString &name, const QImage &icon, QSize maxsize, qreal dpr)
+{
+    PaintContext context;
+    context.image = &icon;
+    context.source = QRectF(icon.rect());
+    context.dpr = dpr;
+    context.staticText = false;
+
+    QSize size = buttonSize(minsize, name, !icon.isNull(), maxsize);
+    QImage ret(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    ret.setDevicePixelRatio(dpr);
+    ret.fill(Qt::transparent);
+
+    QPainter p(&ret);
+    paintBackground(p, QRect(QPoint(0, 0), size), state);
+    paintButtonContent(p, QRect(QPoint(0, 0), size), state, name, context);
+    p.end();
+
+    return ret;
+}
+
+void FlatStyle::setMainColor(const QColor &color)
+{
+    if (mMainColor == color)
+        return;
+    mMainColor = color;
+    mTemplates.clear();
+    invalidate();
+}
+
+QColor FlatStyle::mainColor(void) const
+{
+    return mMainColor;
+}
+
+void FlatStyle::setHightlightColor(const QColor &color)
+{
+    if (mHightlightColor == color)
+        return;
+    mHightlightColor = color;
+    mTemplates.clear();
+    invalidate();
+}
+
+QColor FlatStyle::hightlightColor(void) const
+{
+    return mHightlightColor;
+}
+
+NineSlice FlatStyle::backgroundTemplate(ButtonState state, qreal dpr) const
+{
+    QColor back = background(state);
+    if (!back.isValid())
+        return NineSlice();
+
+    auto key = std::make_tuple(int(state), back.rgba(), dpr);
+    auto it = mTemplates.find(key);
+    if (it != mTemplates.end())
+        return it->second;
+
+    const int side = 2 * TemplateMargin + 1;
+    QPixmap pixmap(QSize(side, side) * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter p(&pixmap);
+    paintBackground(p, QRect(0, 0, side, side), state);
+    p.end();
+
+    NineSlice ret(pixmap, QMargins(TemplateMargin, TemplateMargin, TemplateMargin, TemplateMargin));
+    mTemplates.emplace(key, ret);
+    return ret;
+}
+
+int FlatStyle::templateCount(void) const
+{
+    return int(mTemplates.size());
+}
+
+qint64 FlatStyle::templateBytes(void) const
+{
+    qint64 ret = 0;
+    for (const auto &entry : mTemplates)
+        ret += qint64(entry.second.pixmap().width()) * entry.second.pixmap().height() * entry.second.pixmap().depth() / 8;
+    return ret;
+}
+
+QPixmap FlatStyle::renderTab(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, const QRectF &source, QSize maxsize)
+{
+    QSize size = tabSize(minsize, name, !icon.isNull(), maxsize);
+    QPixmap ret(size * devicePixelRatio());
+    ret.setDevicePixelRatio(devicePixelRatio());
+    ret.fill(Qt::transparent);
+
+    QPainter p(&ret);
+    PaintContext context;
+    context.pixmap = &icon;
+    context.source = source;
+    context.dpr = devicePixelRatio();
+    paintBackground(p, QRect(QPoint(0, 0), size), state);
+    paintTabContent(p, QRect(QPoint(0, 0), size), state, name, context);
+    p.end();
+
+    return ret;
+}
+
+QPixmap FlatStyle::renderButton(QSize minsize, ButtonState state, const QString &name, const QPixmap &icon, const QRectF &source, QSize maxsize)
+{
+    QSize size = buttonSize(minsize, name, !icon.isNull(), maxsize);
+    QPixmap ret(size * devicePixelRatio());
+    ret.setDevicePixelRatio(devicePixelRatio());
+    ret.fill(Qt::transparent);
+
+    QPainter p(&ret);
+    PaintContext context;
+    context.pixmap = &icon;
+    context.source = source;
+    context.dpr = devicePixelRatio();
+    paintBackground(p, QRect(QPoint(0, 0), size), state);
+    paintButtonContent(p, QRect(QPoint(0, 0), size), state, name, context);
+    p.end();
+
+    return ret;
+}
+
+QSize FlatStyle::tabSize(QSize minsize, const QString &name, bool icon, QSize maxsize) const
+{
+    Label label = LabelCache::shared().label(QGuiApplication::font(), name);
+    int width = 2 * TabPadding + label.width;
+    int height = label.height + 2 * Spacing;
+
+    if (icon) {
+        width += TabIconSize + Spacing;
+        height = qMax(height, TabIconSize + 2 * Spacing);
+    }
+
+    return boundSize(QSize(width, height), minsize, maxsize);
+}
+
+QSize FlatStyle::buttonSize(QSize minsize, const QString &name, bool icon, QSize maxsize) const
+{
+    Label label = LabelCache::shared().label(QGuiApplication::font(), name);
+    int width = 2 * ButtonPadding + label.width;
+    int height = 2 * ButtonPadding + label.height;
+
+    if (icon) {
+        width = qMax(width, 2 * ButtonPadding + ButtonIconSize);
+        height += ButtonIconSize + Spacing;
+    }
+
+    return boundSize(QSize(width, height), minsize, maxsize);
+}
+
+bool FlatStyle::PaintContext::hasIcon(void) const
+{
+    return (pixmap != nullptr && !pixmap->isNull()) || (image != nullptr && !image->isNull());
+}
+
+void FlatStyle::PaintContext::drawIcon(QPainter &p, const QRectF &target) const
+{
+    if (pixmap != nullptr)
+        p.drawPixmap(target, *pixmap, source);
+    else
+        p.drawImage(target, *image, source);
+}
+
+void FlatStyle::paintBackground(QPainter &p, const QRect &rect, ButtonState state) const
+{
+    QColor back = background(state);
+    if (back.isValid())
+        p.fillRect(rect, back);
+}
+
+void FlatStyle::paintTabContent(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const PaintContext &context) const
+{
+    QRect content = rect.adjusted(TabPadding, 0, -TabPadding, 0);
+    if (context.hasIcon()) {
+        QRect iconRect(content.left(), content.top() + (content.height() - TabIconSize) / 2, TabIconSize, TabIconSize);
+        context.drawIcon(p, QRectF(iconRect));
+        content.setLeft(iconRect.right() + 1 + Spacing);
+    }
+
+    Label label = LabelCache::shared().label(QGuiApplication::font(), name, content.width(), context.dpr);
+    p.setFont(QGuiApplication::font());
+    p.setPen(foreground(state));
+    QPoint pos(content.left(), content.top() + (content.height() - label.height) / 2);
+    if (context.staticText && label.prepared)
+        p.drawStaticText(pos, label.text);
+    else
+        p.drawText(QRect(pos, QSize(label.elidedWidth, label.height)), Qt::AlignLeft | Qt::AlignTop, label.elided);
+}
+
+void FlatStyle::paintButtonContent(QPainter &p, const QRect &rect, ButtonState state, const QString &name, const PaintContext &context) const
+{
+    QRect content = rect.adjusted(ButtonPadding, ButtonPadding, -ButtonPadding, -ButtonPadding);
+    if (context.hasIcon()) {
+        QRect iconRect(content.left() + (content.width() - ButtonIconSize) / 2, content.top(), ButtonIconSize, ButtonIconSize);
+        context.drawIcon(p, QRectF(iconRect));
+        content.setTop(iconRect.bottom() + 1 + Spacing);
+    }
+
+    Label label = LabelCache::shared().label(QGuiApplication::font(), name, content.width(), context.dpr);
+    p.setFont(QGuiApplication::font());
+    p.setPen(foreground(state));
+    QPoint pos(content.left() + (content.width() - label.elidedWidth) / 2, content.top());
+    if (context.staticText && label.prepared)
+        p.drawStaticText(pos, label.text);
+    else
+        p.drawText(QRect(pos, QSize(label.elidedWidth, label.height)), Qt::AlignLeft | Qt::AlignTop, label.elided);
+}
+
+QColor FlatStyle::background(ButtonState state) const
+{
+    switch (state) {
+    case HOVER:
+        return mHightlightColor;
+    case ACTIVE:
+        return mMainColor;
+    default:
+        return QColor();
+    }
+}
+
+QColor FlatStyle::foreground(ButtonState state) const
+{
+    switch (state) {
+    case HOVER:
+    case ACTIVE:
+        return QColor(Qt::white);
+    case DISABLED:
+        return QColor(Qt::gray);
+    default:
+        return mMainColor;
+    }
+}
+
+}
+
+}
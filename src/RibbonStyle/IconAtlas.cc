@@ -0,0 +1,245 @@
+#include <RibbonStyle/IconAtlas.hh>
+
+#include <atomic>
+#include <climits>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+// Transparent pixels kept between icons so that filtering never samples a neighbour
+static const int Gutter = 1;
+
+static std::atomic<qint64> gNextKey(1);
+
+bool IconHandle::isValid(void) const
+{
+    return atlas != nullptr && atlas->contains(*this);
+}
+
+QPixmap IconHandle::pixmap(void) const
+{
+    if (!isValid())
+        return QPixmap();
+    QPixmap ret = atlas->sheet(sheet).copy(rect);
+    ret.setDevicePixelRatio(dpr);
+    return ret;
+}
+
+bool IconAtlas::Key::operator==(const Key &other) const
+{
+    return icon == other.icon && size == other.size && dpr == other.dpr;
+}
+
+IconAtlas::IconAtlas(const QSize &sheetSize) : mSheetSize(sheetSize), mUsedPixels(0), mGeneration(1)
+{
+}
+
+IconHandle IconAtlas::add(const QPixmap &icon, const QSize &size, qreal dpr)
+{
+    if (icon.isNull())
+        return IconHandle();
+
+    Key key = {icon.cacheKey(), size, dpr};
+    auto it = mHandles.constFind(key);
+    if (it != mHandles.constEnd())
+        return it.value();
+
+    QSize pixels = size * dpr;
+    QSize packed = pixels + QSize(Gutter, Gutter);
+    if (packed.width() > mSheetSize.width() || packed.height() > mSheetSize.height())
+        return IconHandle();
+
+    QPoint pos;
+    int index = 0;
+    while (index < int(mSheets.size()) && !pack(mSheets[index], packed, &pos))
+        index++;
+
+    if (index == int(mSheets.size())) {
+        Sheet sheet;
+        sheet.image = QImage(mSheetSize, QImage::Format_ARGB32_Premultiplied);
+        sheet.image.fill(Qt::transparent);
+        sheet.skyline.push_back({0, 0, mSheetSize.width()});
+        sheet.dirty = true;
+        mSheets.push_back(sheet);
+        pack(mSheets.back(), packed, &pos);
+    }
+
+    Sheet &sheet = mSheets[index];
+    QRect rect(pos, pixels);
+    QPainter p(&sheet.image);
+    p.setRenderHint(QPainter::SmoothPixmapTransform);
+    p.setCompositionMode(QPainter::CompositionMode_Source);
+    p.drawPixmap(rect, icon);
+    p.end();
+    sheet.dirty = true;
+
+    IconHandle handle;
+    handle.atlas = this;
+    handle.sheet = index;
+    handle.generation = mGeneration;
+    handle.rect = rect;
+    handle.dpr = dpr;
+    handle.key = -gNextKey++;
+
+    mHandles.insert(key, handle);
+    mUsedPixels += qint64(pixels.width()) * pixels.height();
+    return handle;
+}
+
+int IconAtlas::sheetCount(void) const
+{
+    return int(mSheets.size());
+}
+
+QPixmap IconAtlas::sheet(int index) const
+{
+    if (index < 0 || index >= int(mSheets.size()))
+        return QPixmap();
+    const Sheet &sheet = mSheets[index];
+    if (sheet.dirty) {
+        sheet.pixmap = QPixmap::fromImage(sheet.image);
+        sheet.dirty = false;
+    }
+    return sheet.pixmap;
+}
+
+bool IconAtlas::contains(const IconHandle &handle) const
+{
+    return handle.atlas == this && handle.generation == mGeneration
+        && handle.sheet >= 0 && handle.sheet < int(mSheets.size());
+}
+
+QRectF IconAtlas::sourceRect(const IconHandle &handle)
+{
+    return QRectF(handle.rect);
+}
+
+void IconAtlas::clear(void)
+{
+    mSheets.clear();
+    mHandles.clear();
+    mUsedPixels = 0;
+    mGeneration++;
+}
+
+IconAtlasStats IconAtlas::stats(void) const
+{
+    IconAtlasStats stats;
+    stats.sheets = int(mSheets.size());
+    stats.icons = mHandles.size();
+    stats.usedPixels = mUsedPixels;
+    for (const Sheet &sheet : mSheets) {
+        stats.totalPixels += qint64(sheet.image.width()) * sheet.image.height();
+        stats.bytes += qint64(sheet.image.bytesPerLine()) * sheet.image.height();
+        if (!sheet.pixmap.isNull())
+            stats.bytes += qint64(sheet.pixmap.width()) * sheet.pixmap.height() * sheet.pixmap.depth() / 8;
+    }
+    return stats;
+}
+
+bool IconAtlas::pack(Sheet &sheet, const QSize &size, QPoint* pos)
+{
+    std::vector<Segment> &skyline = sheet.skyline;
+
+    // Bottom-left rule: lowest position, then the one leaving the narrowest segment
+    int best = -1;
+    int bestY = INT_MAX;
+    int bestWidth = INT_MAX;
+    for (size_t i = 0; i < skyline.size(); i++) {
+        int x = skyline[i].x;
+        if (x + size.width() > mSheetSize.width())
+            break;
+
+        int y = 0;
+        int remaining = size.width();
+        for (size_t j = i; remaining > 0; j++) {
+            y = qMax(y, skyline[j].y);
+            remaining -= skyline[j].width;
+        }
+        if (y + size.height() > mSheetSize.height())
+            continue;
+
+        if (y < bestY || (y == bestY && skyline[i].width < bestWidth)) {
+            best = int(i);
+            bestY = y;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (best < 0)
+        return false;
+
+    *pos = QPoint(skyline[best].x, bestY);
+
+    // New segment on top of the icon, shrinking or removing the segments it covers
+    Segment top = {pos->x(), bestY + size.height(), size.width()};
+    skyline.insert(skyline.begin() + best, top);
+    size_t i = best + 1;
+    while (i < skyline.size()) {
+        Segment &next = skyline[i];
+        int end = top.x + top.width;
+        if (next.x >= end)
+            break;
+        int overlap = end - next.x;
+        if (overlap < next.width) {
+            next.x += overlap;
+            next.width -= overlap;
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // Merge neighbours at the same height
+    for (size_t j = 0; j + 1 < skyline.size();) {
+        if (skyline[j].y == skyline[j + 1].y) {
+            skyline[j].width += skyline[j + 1].width;
+            skyline.erase(skyline.begin() + j + 1);
+        }
+        else {
+            j++;
+        }
+    }
+    return true;
+}
+
+void IconBatch::add(const QRectF &target, const IconHandle &icon, qreal opacity)
+{
+    if (!icon.isValid())
+        return;
+
+    Batch* batch = nullptr;
+    for (Batch &b : mBatches) {
+        if (b.atlas == icon.atlas && b.sheet == icon.sheet) {
+            batch = &b;
+            break;
+        }
+    }
+    if (batch == nullptr) {
+        mBatches.push_back({icon.atlas, icon.sheet, QVector<QPainter::PixmapFragment>()});
+        batch = &mBatches.back();
+    }
+
+    QRectF source = IconAtlas::sourceRect(icon);
+    batch->fragments.append(QPainter::PixmapFragment::create(target.center(), source,
+        target.width() / source.width(), target.height() / source.height(), 0.0, opacity));
+}
+
+void IconBatch::flush(QPainter &painter)
+{
+    for (const Batch &batch : mBatches) {
+        // The atlas may have been cleared since add
+        QPixmap sheet = batch.atlas->sheet(batch.sheet);
+        if (!sheet.isNull())
+            painter.drawPixmapFragments(batch.fragments.constData(), batch.fragments.size(), sheet);
+    }
+    mBatches.clear();
+}
+
+bool IconBatch::isEmpty(void) const
+{
+    return mBatches.empty();
+}
+
+}
+
+}
@@ -0,0 +1,198 @@
+#include <RibbonStyle/LabelCache.hh>
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QFontMetrics>
+#include <QPointer>
+#include <QThread>
+#include <QTransform>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+// Clear the shared cache on application font change (glyphs and advances of every label change)
+class FontChangeFilter : public QObject {
+public:
+    explicit FontChangeFilter(LabelCache* cache) : QObject(QCoreApplication::instance()), mCache(cache)
+    {
+        QCoreApplication::instance()->installEventFilter(this);
+    }
+
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        if (watched == QCoreApplication::instance() && event->type() == QEvent::ApplicationFontChange)
+            mCache->clear();
+        return false;
+    }
+
+private:
+    LabelCache* mCache;
+};
+
+// Only touched from the thread of the application
+static QPointer<FontChangeFilter> gFontChangeFilter;
+
+static void installFontChangeFilter(void)
+{
+    LabelCache::watchFontChanges();
+}
+
+// Run by the QCoreApplication constructor (or at load time if the application already exists)
+Q_COREAPP_STARTUP_FUNCTION(installFontChangeFilter)
+
+static int advance(const QFontMetrics &fm, const QString &text)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
+    return fm.horizontalAdvance(text);
+#else
+    return fm.width(text);
+#endif
+}
+
+bool LabelCache::Key::operator==(const Key &other) const
+{
+    return maxwidth == other.maxwidth && dpr == other.dpr && text == other.text && font == other.font;
+}
+
+uint qHash(const LabelCache::Key &key, uint seed)
+{
+    uint h = qHash(key.font, seed);
+    h = h * 31 + uint(key.maxwidth);
+    h = h * 31 + uint(qRound(key.dpr * 100));
+    return h ^ qHash(key.text, seed);
+}
+
+LabelCache::LabelCache(int capacity) : mCapacity(capacity)
+{
+}
+
+LabelCache &LabelCache::shared(void)
+{
+    static LabelCache cache;
+    return cache;
+}
+
+void LabelCache::watchFontChanges(void)
+{
+    // The filter is a child of the application, it must be created in its thread: never from a worker
+    // rendering through shared() first
+    QCoreApplication* app = QCoreApplication::instance();
+    if (app == nullptr || QThread::currentThread() != app->thread() || !gFontChangeFilter.isNull())
+        return;
+    gFontChangeFilter = new FontChangeFilter(&shared());
+}
+
+void LabelCache::setCapacity(int entries)
+{
+    QMutexLocker lock(&mMutex);
+    mCapacity = entries;
+    trim(mCapacity);
+}
+
+int LabelCache::capacity(void) const
+{
+    QMutexLocker lock(&mMutex);
+    return mCapacity;
+}
+
+Label LabelCache::label(const QFont &font, const QString &text, int maxwidth, qreal dpr)
+{
+    Key key = {font, text, maxwidth, dpr};
+    QCoreApplication* app = QCoreApplication::instance();
+    const bool gui = app != nullptr && QThread::currentThread() == app->thread();
+    QMutexLocker lock(&mMutex);
+
+    auto it = mIndex.constFind(key);
+    if (it != mIndex.constEnd()) {
+        mEntries.splice(mEntries.begin(), mEntries, it.value());
+        mStats.hits++;
+        Label label = it.value()->label;
+        if (label.prepared || !gui)
+            return label;
+
+        // Measured by a worker: shaped on the first lookup from the GUI thread
+        lock.unlock();
+        prepare(key, &label);
+        lock.relock();
+        it = mIndex.constFind(key);
+        if (it != mIndex.constEnd())
+            it.value()->label = label;
+        return label;
+    }
+
+    mStats.misses++;
+    // Shaping is done unlocked: it is the expensive part and doesn't touch the cache
+    lock.unlock();
+    Label label = measure(key);
+    if (gui)
+        prepare(key, &label);
+    lock.relock();
+    if (mIndex.contains(key))
+        return label;
+    if (mCapacity <= 0)
+        return label;
+
+    trim(mCapacity - 1);
+    mEntries.push_front({key, label});
+    mIndex.insert(key, mEntries.begin());
+    mStats.entries = mIndex.size();
+    return label;
+}
+
+void LabelCache::clear(void)
+{
+    QMutexLocker lock(&mMutex);
+    mEntries.clear();
+    mIndex.clear();
+    mStats.entries = 0;
+}
+
+LabelCacheStats LabelCache::stats(void) const
+{
+    QMutexLocker lock(&mMutex);
+    return mStats;
+}
+
+void LabelCache::resetStats(void)
+{
+    QMutexLocker lock(&mMutex);
+    mStats.hits = 0;
+    mStats.misses = 0;
+    mStats.evictions = 0;
+}
+
+Label LabelCache::measure(const Key &key)
+{
+    QFontMetrics fm(key.font);
+
+    Label label;
+    label.width = advance(fm, key.text);
+    label.height = fm.height();
+    label.elided = key.maxwidth >= 0 && label.width > key.maxwidth
+        ? fm.elidedText(key.text, Qt::ElideRight, key.maxwidth) : key.text;
+    label.elidedWidth = label.elided.size() == key.text.size() ? label.width : advance(fm, label.elided);
+    return label;
+}
+
+void LabelCache::prepare(const Key &key, Label* label)
+{
+    label->text.setTextFormat(Qt::PlainText);
+    label->text.setText(label->elided);
+    label->text.prepare(QTransform::fromScale(key.dpr, key.dpr), key.font);
+    label->prepared = true;
+}
+
+void LabelCache::trim(int capacity)
+{
+    while (!mEntries.empty() && int(mEntries.size()) > capacity) {
+        mIndex.remove(mEntries.back().key);
+        mEntries.pop_back();
+        mStats.evictions++;
+    }
+    mStats.entries = mIndex.size();
+}
+
+}
+
+}
@@ -0,0 +1,62 @@
+#include <RibbonStyle/NineSlice.hh>
+
+#include <QPainter>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+NineSlice::NineSlice(const QPixmap &pixmap, const QMargins &margins) : mPixmap(pixmap), mMargins(margins)
+{
+}
+
+bool NineSlice::isNull(void) const
+{
+    return mPixmap.isNull();
+}
+
+QPixmap NineSlice::pixmap(void) const
+{
+    return mPixmap;
+}
+
+QMargins NineSlice::margins(void) const
+{
+    return mMargins;
+}
+
+QSize NineSlice::minimumSize(void) const
+{
+    return QSize(mMargins.left() + mMargins.right(), mMargins.top() + mMargins.bottom());
+}
+
+void NineSlice::draw(QPainter &p, const QRect &target) const
+{
+    if (mPixmap.isNull() || target.isEmpty())
+        return;
+
+    // Target margins shrink with a target smaller than the corners, source margins are in pixmap pixels
+    const qreal dpr = mPixmap.devicePixelRatio();
+    const qreal left = qMin(mMargins.left(), target.width() / 2);
+    const qreal right = qMin(mMargins.right(), target.width() - int(left));
+    const qreal top = qMin(mMargins.top(), target.height() / 2);
+    const qreal bottom = qMin(mMargins.bottom(), target.height() - int(top));
+
+    const qreal tx[4] = {qreal(target.left()), target.left() + left, target.left() + target.width() - right, qreal(target.left() + target.width())};
+    const qreal ty[4] = {qreal(target.top()), target.top() + top, target.top() + target.height() - bottom, qreal(target.top() + target.height())};
+    const qreal sx[4] = {0, mMargins.left() * dpr, mPixmap.width() - mMargins.right() * dpr, qreal(mPixmap.width())};
+    const qreal sy[4] = {0, mMargins.top() * dpr, mPixmap.height() - mMargins.bottom() * dpr, qreal(mPixmap.height())};
+
+    for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < 3; column++) {
+            QRectF to(QPointF(tx[column], ty[row]), QPointF(tx[column + 1], ty[row + 1]));
+            QRectF from(QPointF(sx[column], sy[row]), QPointF(sx[column + 1], sy[row + 1]));
+            if (!to.isEmpty() && !from.isEmpty())
+                p.drawPixmap(to, mPixmap, from);
+        }
+    }
+}
+
+}
+
+}
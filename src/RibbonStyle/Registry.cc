@@ -0,0 +1,168 @@
+#include <RibbonStyle/Flat.hh>
+#include <RibbonStyle/Registry.hh>
+#include <StartupTrace.hh>
+
+#include <QCoreApplication>
+
+namespace RibbonUI {
+
+namespace RibbonStyle {
+
+StyleRegistry &StyleRegistry::shared(void)
+{
+    static StyleRegistry registry;
+    return registry;
+}
+
+StyleRegistry::StyleRegistry(void) : mCache(32 * 1024 * 1024), mCleanupRegistered(false)
+{
+    registerFactory("flat", []() -> RibbonStyle* { return new FlatStyle(); });
+}
+
+void StyleRegistry::registerFactory(const QString &id, const Factory &factory)
+{
+    mFactories[id] = factory;
+}
+
+bool StyleRegistry::hasFactory(const QString &id) const
+{
+    return mFactories.count(id) != 0;
+}
+
+CachedStyle* StyleRegistry::acquire(const QString &id, const void* window)
+{
+    auto it = mStyles.find(id);
+    if (it == mStyles.end()) {
+        auto factory = mFactories.find(id);
+        if (factory == mFactories.end())
+            return nullptr;
+
+        STARTUP_SCOPE("StyleRegistry: style instantiation");
+        Entry entry;
+        entry.style.reset(factory->second());
+        if (!entry.style)
+            return nullptr;
+        entry.cached.reset(new CachedStyle(entry.style.get(), &mCache));
+        it = mStyles.emplace(id, std::move(entry)).first;
+
+        // Run once per application, which may be created again afterwards
+        if (!mCleanupRegistered && QCoreApplication::instance() != nullptr) {
+            qAddPostRoutine(cleanup);
+            mCleanupRegistered = true;
+        }
+    }
+
+    it->second.windows[window]++;
+    return it->second.cached.get();
+}
+
+void StyleRegistry::release(const QString &id, const void* window)
+{
+    auto it = mStyles.find(id);
+    if (it == mStyles.end())
+        return;
+
+    auto user = it->second.windows.find(window);
+    if (user == it->second.windows.end())
+        return;
+    if (--user->second == 0)
+        it->second.windows.erase(user);
+    if (it->second.windows.empty())
+        destroy(it);
+}
+
+void StyleRegistry::releaseAll(const void* window)
+{
+    for (auto it = mStyles.begin(); it != mStyles.end();) {
+        auto next = std::next(it);
+        it->second.windows.erase(window);
+        if (it->second.windows.empty())
+            destroy(it);
+        it = next;
+    }
+}
+
+int StyleRegistry::users(const QString &id) const
+{
+    auto it = mStyles.find(id);
+    return it == mStyles.end() ? 0 : int(it->second.windows.size());
+}
+
+int StyleRegistry::references(const QString &id, const void* window) const
+{
+    auto it = mStyles.find(id);
+    if (it == mStyles.end())
+        return 0;
+    auto user = it->second.windows.find(window);
+    return user == it->second.windows.end() ? 0 : user->second;
+}
+
+void StyleRegistry::setBudget(qint64 bytes)
+{
+    mCache.setBudget(bytes);
+}
+
+qint64 StyleRegistry::budget(void) const
+{
+    return mCache.budget();
+}
+
+PixmapCache &StyleRegistry::cache(void)
+{
+    return mCache;
+}
+
+StyleMemoryReport StyleRegistry::report(void) const
+{
+    StyleMemoryReport ret;
+    ret.budget = mCache.budget();
+    for (const auto &style : mStyles) {
+        qint64 bytes = mCache.bytes(style.second.style.get());
+        ret.styles++;
+        if (style.second.windows.size() > 1)
+            ret.sharedBytes += bytes;
+        else
+            ret.uniqueBytes += bytes;
+    }
+    ret.attributedBytes = ret.sharedBytes + ret.uniqueBytes;
+    return ret;
+}
+
+StyleMemoryReport StyleRegistry::report(const void* window) const
+{
+    StyleMemoryReport ret;
+    ret.budget = mCache.budget();
+    for (const auto &style : mStyles) {
+        if (style.second.windows.count(window) == 0)
+            continue;
+
+        qint64 bytes = mCache.bytes(style.second.style.get());
+        qint64 users = qint64(style.second.windows.size());
+        ret.styles++;
+        if (users > 1)
+            ret.sharedBytes += bytes;
+        else
+            ret.uniqueBytes += bytes;
+        ret.attributedBytes += bytes / users;
+    }
+    return ret;
+}
+
+void StyleRegistry::destroy(std::map<QString, Entry>::iterator it)
+{
+    mCache.clear(it->second.style.get());
+    mStyles.erase(it);
+}
+
+void StyleRegistry::cleanup(void)
+{
+    // Windows are gone by now; the registry itself is only destroyed at exit, without an application
+    StyleRegistry &registry = shared();
+    registry.mCache.clear();
+    registry.mStyles.clear();
+    registry.mCleanupRegistered = false;
+}
+
+}
+
+}
@@ -0,0 +1,459 @@
+#include <RibbonTab.hh>
+
+#include <QFontMetrics>
+#include <QGuiApplication>
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+namespace RibbonUI {
+
+Tab::ControlRender Tab::controlRender(ControlSize size)
+{
+    switch (size) {
+    case MediumControl:
+        // Small icon and label on one line, as rendered for tabs
+        return {false, QSize(0, RowHeight), true};
+    case SmallControl:
+        return {false, QSize(RowHeight, RowHeight), false};
+    default:
+        return {true, QSize(0, ControlsHeight), true};
+    }
+}
+
+Tab::Tab(const QString &name) : mName(name), mDirty(true), mAvailableWidth(INT_MAX), mStep(0), mMeasured(0)
+{
+}
+
+void Tab::setName(const QString &name)
+{
+    mName = name;
+}
+
+QString Tab::name(void) const
+{
+    return mName;
+}
+
+GroupId Tab::addGroup(const QString &title)
+{
+    Group group;
+    group.title = title;
+    group.first = int(mControls.size());
+    group.count = 0;
+    group.dirty = true;
+    group.x = 0;
+    group.level = 0;
+    for (int i = 0; i < GroupVariantCount; i++) {
+        group.width[i] = 0;
+        group.variants[i] = GroupLarge;
+    }
+    mGroups.push_back(group);
+    mDirty = true;
+    return GroupId(mGroups.size() - 1);
+}
+
+ControlId Tab::addControl(GroupId group, const QString &label, const QPixmap &icon, ControlSize size)
+{
+    Q_ASSERT(group >= 0 && group < groupCount());
+
+    Control control;
+    control.id = ControlId(mControlIndex.size());
+    control.group = group;
+    control.label = label;
+    control.icon = icon;
+    control.size = size;
+    control.visible = true;
+    control.dirty = true;
+    control.state = RibbonStyle::NORMAL;
+    control.command = -1;
+
+    // Controls stay sorted by group: appending to the last group is the common (and cheap) case
+    Group &g = mGroups[group];
+    int index = g.first + g.count;
+    mControls.insert(mControls.begin() + index, control);
+    g.count++;
+    g.dirty = true;
+    mDirty = true;
+
+    for (size_t i = group + 1; i < mGroups.size(); i++)
+        mGroups[i].first++;
+    for (size_t i = index + 1; i < mControls.size(); i++)
+        mControlIndex[mControls[i].id] = int(i);
+    mControlIndex.push_back(index);
+
+    return control.id;
+}
+
+void Tab::setGroupTitle(GroupId group, const QString &title)
+{
+    Group &g = mGroups[group];
+    if (g.title == title)
+        return;
+    g.title = title;
+    g.dirty = true;
+    mDirty = true;
+}
+
+QString Tab::groupTitle(GroupId group) const
+{
+    return mGroups[group].title;
+}
+
+void Tab::setLabel(ControlId id, const QString &label)
+{
+    Control &c = control(id);
+    if (c.label == label)
+        return;
+    c.label = label;
+    markDirty(id);
+}
+
+QString Tab::label(ControlId id) const
+{
+    return control(id).label;
+}
+
+void Tab::setIcon(ControlId id, const QPixmap &icon)
+{
+    Control &c = control(id);
+    if (c.icon.cacheKey() == icon.cacheKey())
+        return;
+    c.icon = icon;
+    markDirty(id);
+}
+
+QPixmap Tab::icon(ControlId id) const
+{
+    return control(id).icon;
+}
+
+void Tab::setSize(ControlId id, ControlSize size)
+{
+    Control &c = control(id);
+    if (c.size == size)
+        return;
+    c.size = size;
+    markDirty(id);
+}
+
+ControlSize Tab::size(ControlId id) const
+{
+    return control(id).size;
+}
+
+void Tab::setVisible(ControlId id, bool visible)
+{
+    Control &c = control(id);
+    if (c.visible == visible)
+        return;
+    c.visible = visible;
+    // The measured size is still valid, only the arrangement of the group changes
+    mGroups[c.group].dirty = true;
+    mDirty = true;
+}
+
+bool Tab::isVisible(ControlId id) const
+{
+    return control(id).visible;
+}
+
+bool Tab::setState(ControlId id, RibbonStyle::ButtonState state)
+{
+    Control &c = control(id);
+    if (c.state == state)
+        return false;
+    c.state = state;
+    return true;
+}
+
+RibbonStyle::ButtonState Tab::state(ControlId id) const
+{
+    return control(id).state;
+}
+
+void Tab::setCommand(ControlId id, CommandId command)
+{
+    Control &c = control(id);
+    if (c.command == command)
+        return;
+
+    if (c.command >= 0) {
+        std::vector<ControlId> &controls = mCommandControls[c.command];
+        controls.erase(std::find(controls.begin(), controls.end(), id));
+        if (controls.empty())
+            mCommandControls.erase(c.command);
+    }
+    c.command = command;
+    if (command >= 0)
+        mCommandControls[command].push_back(id);
+}
+
+CommandId Tab::command(ControlId id) const
+{
+    return control(id).command;
+}
+
+const std::vector<ControlId> &Tab::commandControls(CommandId command) const
+{
+    static const std::vector<ControlId> none;
+    auto it = mCommandControls.find(command);
+    return it == mCommandControls.end() ? none : it->second;
+}
+
+GroupId Tab::group(ControlId id) const
+{
+    return control(id).group;
+}
+
+ControlSize Tab::displayedSize(ControlId id) const
+{
+    const Control &c = control(id);
+    const Group &g = mGroups[c.group];
+    return ControlSize(std::max(int(c.size), std::min(int(g.variants[g.level]), int(SmallControl))));
+}
+
+int Tab::groupCount(void) const
+{
+    return int(mGroups.size());
+}
+
+int Tab::controlCount(void) const
+{
+    return int(mControls.size());
+}
+
+bool Tab::layout(RibbonStyle::RibbonStyle &style)
+{
+    mMeasured = 0;
+    if (!mDirty)
+        return false;
+
+    for (Group &group : mGroups) {
+        if (group.dirty)
+            layoutGroup(style, group);
+    }
+    updateBreakpoints();
+    applyStep(findStep());
+    mDirty = false;
+    return true;
+}
+
+bool Tab::needsLayout(void) const
+{
+    return mDirty;
+}
+
+void Tab::invalidate(void)
+{
+    for (Control &control : mControls)
+        control.dirty = true;
+    for (Group &group : mGroups)
+        group.dirty = true;
+    mDirty = true;
+}
+
+bool Tab::setAvailableWidth(int width)
+{
+    mAvailableWidth = width;
+    // layout() will pick the step
+    if (mDirty)
+        return false;
+    return applyStep(findStep());
+}
+
+int Tab::availableWidth(void) const
+{
+    return mAvailableWidth;
+}
+
+GroupVariant Tab::groupVariant(GroupId group) const
+{
+    const Group &g = mGroups[group];
+    return g.variants[g.level];
+}
+
+const std::vector<int> &Tab::breakpoints(void) const
+{
+    return mBreakpoints;
+}
+
+QRect Tab::groupGeometry(GroupId group) const
+{
+    const Group &g = mGroups[group];
+    return QRect(g.x, 0, g.width[g.variants[g.level]], ControlsHeight + GroupTitleHeight + 2 * GroupPadding);
+}
+
+QRect Tab::controlGeometry(ControlId id) const
+{
+    const Control &c = control(id);
+    const Group &g = mGroups[c.group];
+    GroupVariant variant = g.variants[g.level];
+    if (!c.visible || variant == GroupCollapsed)
+        return QRect();
+    return c.geometry[variant].translated(g.x, 0);
+}
+
+QSize Tab::sizeHint(void) const
+{
+    int width = mBreakpoints.empty() ? 0 : mBreakpoints[mStep];
+    return QSize(width, ControlsHeight + GroupTitleHeight + 2 * GroupPadding);
+}
+
+int Tab::measuredControls(void) const
+{
+    return mMeasured;
+}
+
+Tab::Control &Tab::control(ControlId id)
+{
+    Q_ASSERT(id >= 0 && id < int(mControlIndex.size()));
+    return mControls[mControlIndex[id]];
+}
+
+const Tab::Control &Tab::control(ControlId id) const
+{
+    Q_ASSERT(id >= 0 && id < int(mControlIndex.size()));
+    return mControls[mControlIndex[id]];
+}
+
+void Tab::markDirty(ControlId id)
+{
+    Control &c = control(id);
+    c.dirty = true;
+    mGroups[c.group].dirty = true;
+    mDirty = true;
+}
+
+QSize Tab::measure(RibbonStyle::RibbonStyle &style, const Control &control, ControlSize size) const
+{
+    ControlRender render = controlRender(size);
+    QString label = render.label ? control.label : QString();
+    QPixmap pixmap = render.button
+        ? style.drawButton(render.minsize, RibbonStyle::NORMAL, label, control.icon)
+        : style.drawTab(render.minsize, RibbonStyle::NORMAL, label, control.icon);
+    return pixmap.size() / pixmap.devicePixelRatio();
+}
+
+void Tab::layoutGroup(RibbonStyle::RibbonStyle &style, Group &group)
+{
+    auto begin = mControls.begin() + group.first;
+    auto end = begin + group.count;
+
+    // Measured once per size: the pixmaps drawn here are the ones painted later (through a CachedStyle)
+    QPixmap icon;
+    for (auto it = begin; it != end; ++it) {
+        Control &c = *it;
+        if (c.dirty) {
+            for (int size = c.size; size <= SmallControl; size++)
+                c.measured[size] = measure(style, c, ControlSize(size));
+            c.dirty = false;
+            mMeasured++;
+        }
+        if (c.visible && icon.isNull())
+            icon = c.icon;
+    }
+
+    QFontMetrics metrics(QGuiApplication::font());
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
+    int titleWidth = metrics.horizontalAdvance(group.title) + 2 * GroupPadding;
+#else
+    int titleWidth = metrics.width(group.title) + 2 * GroupPadding;
+#endif
+
+    // A control is never made larger than it was declared
+    for (int variant = GroupLarge; variant < GroupCollapsed; variant++) {
+        // Large controls take a whole column, medium and small ones are stacked while they fit in ControlsHeight.
+        // A row is as high as the control drawn by the style, RowHeight at least.
+        int x = GroupPadding;
+        int column = 0;
+        int y = 0;
+        for (auto it = begin; it != end; ++it) {
+            Control &c = *it;
+            if (!c.visible)
+                continue;
+            ControlSize size = ControlSize(std::max(int(c.size), variant));
+            QSize measured = c.measured[size];
+
+            if (size == LargeControl) {
+                x += column;
+                column = 0;
+                y = 0;
+                c.geometry[variant] = QRect(x, GroupPadding, measured.width(), ControlsHeight);
+                x += measured.width();
+                continue;
+            }
+
+            int height = std::max(int(RowHeight), measured.height());
+            if (y > 0 && y + height > ControlsHeight) {
+                x += column;
+                column = 0;
+                y = 0;
+            }
+            c.geometry[variant] = QRect(x, GroupPadding + y, measured.width(), height);
+            column = std::max(column, measured.width());
+            y += height;
+        }
+        x += column + GroupPadding;
+        group.width[variant] = std::max(x, titleWidth);
+    }
+
+    // Collapsed: a single large button named after the group, opening its controls
+    QPixmap button = style.drawButton(QSize(0, ControlsHeight), RibbonStyle::NORMAL, group.title, icon);
+    group.width[GroupCollapsed] = qRound(button.width() / button.devicePixelRatio()) + 2 * GroupPadding;
+
+    group.variants[GroupLarge] = GroupLarge;
+    for (int level = GroupMedium; level < GroupVariantCount; level++) {
+        GroupVariant previous = group.variants[level - 1];
+        group.variants[level] = group.width[level] < group.width[previous] ? GroupVariant(level) : previous;
+    }
+    group.dirty = false;
+}
+
+void Tab::updateBreakpoints(void)
+{
+    // Step s + 1 reduces one group by one level: the last group first, then the one before...
+    int count = groupCount();
+    mBreakpoints.resize(count * (GroupVariantCount - 1) + 1);
+
+    int width = 0;
+    for (const Group &group : mGroups)
+        width += group.width[GroupLarge];
+    mBreakpoints[0] = width;
+
+    for (int step = 0; step + 1 < int(mBreakpoints.size()); step++) {
+        const Group &group = mGroups[count - 1 - step % count];
+        int level = step / count;
+        width += group.width[group.variants[level + 1]] - group.width[group.variants[level]];
+        mBreakpoints[step + 1] = width;
+    }
+}
+
+int Tab::findStep(void) const
+{
+    auto it = std::lower_bound(mBreakpoints.begin(), mBreakpoints.end(), mAvailableWidth, std::greater<int>());
+    if (it == mBreakpoints.end())
+        return std::max(0, int(mBreakpoints.size()) - 1);
+    return int(it - mBreakpoints.begin());
+}
+
+bool Tab::applyStep(int step)
+{
+    int count = groupCount();
+    bool changed = false;
+    int x = 0;
+    for (int i = 0; i < count; i++) {
+        Group &group = mGroups[i];
+        int level = step / count + (count - 1 - i < step % count ? 1 : 0);
+        if (group.variants[level] != group.variants[group.level])
+            changed = true;
+        group.level = level;
+        group.x = x;
+        x += group.width[group.variants[level]];
+    }
+    mStep = step;
+    return changed;
+}
+
+}
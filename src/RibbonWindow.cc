@@ -0,0 +1,313 @@
+#include "RibbonWindow.hh"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace RibbonUI {
+
+// Posted by the command store when it gets changes
+static const QEvent::Type CommandStateEvent = QEvent::Type(QEvent::registerEventType());
+// Delay between two prefetched pages, leaving the event loop to input and painting
+static const int PrefetchInterval = 50;
+
+Window::Window(QWidget* parent, Qt::WindowFlags flags) : CustomWindow::CustomWindow(parent, flags) {
+	STARTUP_SCOPE("RibbonUI::Window::Window");
+	setRibbonStyle("flat");
+
+	mPrefetchTimer.setSingleShot(true);
+	mPrefetchTimer.setInterval(PrefetchInterval);
+	connect(&mPrefetchTimer, &QTimer::timeout, this, [this]() { prefetchNext(); });
+}
+
+Window::~Window() {
+	setCommandStore(nullptr);
+	mPages.clear();
+	mRenderer.reset();
+	RibbonStyle::StyleRegistry::shared().releaseAll(this);
+}
+
+bool Window::setRibbonStyle(const QString& id) {
+	RibbonStyle::StyleRegistry& registry = RibbonStyle::StyleRegistry::shared();
+	if (id == mStyleId && mStyle != nullptr)
+		return true;
+
+	RibbonStyle::CachedStyle* acquired = registry.acquire(id, this);
+	if (acquired == nullptr)
+		return false;
+
+	// Pending pre-rendering belongs to the previous style
+	mRenderer.reset();
+	if (mStyle != nullptr)
+		registry.release(mStyleId, this);
+	mStyleId = id;
+	mStyle = acquired;
+	mRenderer.reset(new RibbonStyle::AsyncRenderer(mStyle));
+
+	// Built pages are measured with the previous style, the current one is laid out again now and the
+	// others when they are activated
+	for (int i = 0; i < int(mPages.size()); i++) {
+		if (mPages[i].tab == nullptr)
+			continue;
+		mPages[i].tab->invalidate();
+		if (i == mCurrent) {
+			mPages[i].tab->layout(*mStyle);
+			mPages[i].tab->setAvailableWidth(width());
+		}
+	}
+
+	update();
+	return true;
+}
+
+QString Window::ribbonStyleId(void) const {
+	return mStyleId;
+}
+
+RibbonStyle::CachedStyle* Window::ribbonStyle(void) const {
+	return mStyle;
+}
+
+RibbonStyle::StyleMemoryReport Window::styleMemory(void) const {
+	return RibbonStyle::StyleRegistry::shared().report(this);
+}
+
+int Window::addTab(const QString& title, const TabBuilder& builder) {
+	TabPage page;
+	page.title = title;
+	page.builder = builder;
+	mPages.push_back(std::move(page));
+	mStats.registered++;
+	return int(mPages.size()) - 1;
+}
+
+int Window::tabCount(void) const {
+	return int(mPages.size());
+}
+
+QString Window::tabTitle(int index) const {
+	if (index < 0 || index >= int(mPages.size()))
+		return QString();
+	return mPages[index].title;
+}
+
+void Window::setCurrentTab(int index) {
+	if (index < 0 || index >= int(mPages.size()) || index == mCurrent)
+		return;
+
+	mCurrent = index;
+	Tab* tab = materialize(index);
+	if (tab->needsLayout() && mStyle != nullptr) {
+		tab->layout(*mStyle);
+		tab->setAvailableWidth(width());
+	}
+	enforceLimit();
+	update();
+}
+
+int Window::currentTab(void) const {
+	return mCurrent;
+}
+
+void Window::prefetchTab(int index) {
+	if (index < 0 || index >= int(mPages.size()) || mPages[index].tab != nullptr)
+		return;
+	if (std::find(mPrefetch.begin(), mPrefetch.end(), index) != mPrefetch.end())
+		return;
+
+	mPrefetch.push_back(index);
+	// Started by the first paint otherwise: a page built before would delay the first frame
+	if (mPainted && !mPrefetchTimer.isActive())
+		mPrefetchTimer.start();
+}
+
+void Window::prefetchNext(void) {
+	while (!mPrefetch.empty()) {
+		int index = mPrefetch.front();
+		mPrefetch.pop_front();
+		if (index < int(mPages.size()) && mPages[index].tab == nullptr) {
+			materialize(index);
+			enforceLimit();
+			break;
+		}
+	}
+	if (!mPrefetch.empty())
+		mPrefetchTimer.start();
+}
+
+bool Window::isMaterialized(int index) const {
+	return index >= 0 && index < int(mPages.size()) && mPages[index].tab != nullptr;
+}
+
+Tab* Window::tab(int index) const {
+	if (index < 0 || index >= int(mPages.size()))
+		return nullptr;
+	return mPages[index].tab.get();
+}
+
+void Window::setMaterializedLimit(int count) {
+	mLimit = qMax(0, count);
+	enforceLimit();
+}
+
+int Window::materializedLimit(void) const {
+	return mLimit;
+}
+
+int Window::releaseIdleTabs(void) {
+	int released = 0;
+	for (int i = 0; i < int(mPages.size()); i++) {
+		if (i != mCurrent && mPages[i].tab != nullptr) {
+			dematerialize(i);
+			released++;
+		}
+	}
+	return released;
+}
+
+TabPageStats Window::tabStats(void) const {
+	return mStats;
+}
+
+bool Window::setCommandStore(CommandStateStore* store) {
+	if (store == mCommandStore)
+		return true;
+
+	// Any thread: at most one event by drain. The store calls it under a lock which unsetting it (from the
+	// destructor at the latest) waits for, so the window is alive during the call.
+	if (store != nullptr && !store->setNotifier([this]() { QCoreApplication::postEvent(this, new QEvent(CommandStateEvent)); }))
+		return false;
+
+	if (mCommandStore != nullptr)
+		mCommandStore->setNotifier(nullptr);
+	mCommandStore = store;
+	if (store == nullptr)
+		return true;
+
+	store->drain(nullptr);
+	for (TabPage& page : mPages) {
+		if (page.tab != nullptr)
+			applyCommandStates(*page.tab);
+	}
+	update();
+	return true;
+}
+
+CommandStateStore* Window::commandStore(void) const {
+	return mCommandStore;
+}
+
+int Window::syncCommandStates(void) {
+	if (mCommandStore == nullptr)
+		return 0;
+
+	mCommandChanges.clear();
+	int count = mCommandStore->drain(&mCommandChanges);
+
+	bool repaint = false;
+	for (const CommandChange& change : mCommandChanges) {
+		RibbonStyle::ButtonState state = change.current.buttonState();
+		if (state == change.previous.buttonState())
+			continue;
+
+		for (int i = 0; i < int(mPages.size()); i++) {
+			Tab* tab = mPages[i].tab.get();
+			if (tab == nullptr)
+				continue;
+			for (ControlId control : tab->commandControls(change.command)) {
+				if (tab->setState(control, state) && i == mCurrent && !tab->controlGeometry(control).isNull())
+					repaint = true;
+			}
+		}
+	}
+
+	if (repaint)
+		update();
+	return count;
+}
+
+bool Window::event(QEvent* eve) {
+	if (eve->type() == CommandStateEvent) {
+		syncCommandStates();
+		return true;
+	}
+	if (eve->type() == QEvent::Paint && !mPainted) {
+		bool ret = CustomWindow::event(eve);
+		mPainted = true;
+		if (!mPrefetch.empty())
+			mPrefetchTimer.start();
+		return ret;
+	}
+	return CustomWindow::event(eve);
+}
+
+void Window::resizeEvent(QResizeEvent* eve) {
+	CustomWindow::resizeEvent(eve);
+	if (mCurrent >= 0 && mPages[mCurrent].tab != nullptr)
+		mPages[mCurrent].tab->setAvailableWidth(width());
+}
+
+Tab* Window::materialize(int index) {
+	TabPage& page = mPages[index];
+	page.lastUse = ++mUseClock;
+	if (page.tab != nullptr)
+		return page.tab.get();
+
+	STARTUP_SCOPE("RibbonUI::Window: tab page materialization");
+	QElapsedTimer timer;
+	timer.start();
+
+	page.tab.reset(new Tab(page.title));
+	if (page.builder)
+		page.builder(*page.tab);
+	applyCommandStates(*page.tab);
+	if (mStyle != nullptr) {
+		page.tab->layout(*mStyle);
+		page.tab->setAvailableWidth(width());
+		mRenderer->prerender(*page.tab);
+	}
+
+	mStats.buildNs += timer.nsecsElapsed();
+	mStats.materializations++;
+	mStats.materialized++;
+	return page.tab.get();
+}
+
+void Window::applyCommandStates(Tab& tab) {
+	if (mCommandStore == nullptr)
+		return;
+	for (ControlId control = 0; control < tab.controlCount(); control++) {
+		if (tab.command(control) >= 0)
+			tab.setState(control, mCommandStore->state(tab.command(control)).buttonState());
+	}
+}
+
+void Window::dematerialize(int index) {
+	// The descriptor stays, the page is built again on its next activation. Its pixmaps stay in the shared
+	// cache until they are evicted.
+	mPages[index].tab.reset();
+	mStats.dematerializations++;
+	mStats.materialized--;
+}
+
+void Window::enforceLimit(void) {
+	if (mLimit == 0)
+		return;
+
+	while (mStats.materialized > mLimit) {
+		int oldest = -1;
+		for (int i = 0; i < int(mPages.size()); i++) {
+			if (i == mCurrent || mPages[i].tab == nullptr)
+				continue;
+			if (oldest < 0 || mPages[i].lastUse < mPages[oldest].lastUse)
+				oldest = i;
+		}
+		if (oldest < 0)
+			return;
+		dematerialize(oldest);
+	}
+}
+
+}
@@ -0,0 +1,218 @@
+// CustomWindow
+// Copyright (C) 2018 Citorva
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "StartupTrace.hh"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+	#include <windows.h>
+#elif defined(Q_OS_LINUX)
+	#include <unistd.h>
+#endif
+
+namespace CustomWindow {
+
+struct TraceEvent {
+	const char* name;
+	char phase;
+	qint64 start;
+	qint64 duration;
+	int thread;
+};
+
+// Time between the process creation and the static initialisation of this file (loader, static
+// constructors of the libraries loaded before), 0 if unknown
+static qint64 processAge(void) {
+#if defined(Q_OS_WIN)
+	FILETIME creation, exit, kernel, user, now;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return 0;
+	GetSystemTimeAsFileTime(&now);
+	auto ns = [](const FILETIME& t) { return ((qint64(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 100; };
+	return qMax<qint64>(0, ns(now) - ns(creation));
+#elif defined(Q_OS_LINUX)
+	// Start time in clock ticks after boot (22nd field of /proc/self/stat) against the uptime, both with a
+	// resolution of about 10 ms
+	char buffer[1024];
+	double uptime = 0.0;
+	unsigned long long start = 0;
+
+	FILE* file = fopen("/proc/uptime", "r");
+	if (file == nullptr)
+		return 0;
+	bool ok = fscanf(file, "%lf", &uptime) == 1;
+	fclose(file);
+
+	file = fopen("/proc/self/stat", "r");
+	if (file == nullptr)
+		return 0;
+	size_t size = fread(buffer, 1, sizeof(buffer) - 1, file);
+	fclose(file);
+	buffer[size] = '\0';
+
+	// The command name may hold spaces, fields are counted from the closing parenthesis (field 2)
+	const char* field = strrchr(buffer, ')');
+	for (int i = 2; field != nullptr && i < 22; i++)
+		field = strchr(field + 1, ' ');
+	if (!ok || field == nullptr || sscanf(field, " %llu", &start) != 1)
+		return 0;
+
+	qint64 age = qint64((uptime - double(start) / sysconf(_SC_CLK_TCK)) * 1e9);
+	return qMax<qint64>(0, age);
+#else
+	return 0;
+#endif
+}
+
+static const std::chrono::steady_clock::time_point gOrigin = std::chrono::steady_clock::now();
+static const qint64 gProcessAge = processAge();
+
+static TraceEvent gEvents[StartupTrace::Capacity];
+static std::atomic<quint64> gNext(0);
+static std::atomic<int> gNextThread(0);
+
+static std::atomic<bool> gEnabled(false);
+static std::atomic<bool> gRecording(true);
+static QString gFile;
+static bool gPostRoutine = false;
+
+static void writeAtExit(void) {
+	if (gEnabled.load() && !gFile.isEmpty())
+		StartupTrace::write(gFile);
+}
+
+static void record(const char* name, char phase, qint64 start, qint64 duration) {
+	if (!gEnabled.load(std::memory_order_relaxed) || !gRecording.load(std::memory_order_relaxed))
+		return;
+
+	thread_local int thread = gNextThread.fetch_add(1, std::memory_order_relaxed);
+	quint64 index = gNext.fetch_add(1, std::memory_order_relaxed);
+	gEvents[index % StartupTrace::Capacity] = {name, phase, start, duration, thread};
+}
+
+// Environment variable read at load time, so that the loading itself is in the trace
+static bool gFromEnvironment = []() {
+	const char* file = getenv("RIBBON_STARTUP_TRACE");
+	if (file == nullptr || *file == '\0')
+		return false;
+	gFile = QString::fromLocal8Bit(file);
+	gEnabled.store(true);
+	record("process loading", 'X', 0, gProcessAge);
+	return true;
+}();
+
+// End of the QCoreApplication (or QApplication) constructor
+static void applicationStarted(void) {
+	StartupTrace::mark("QApplication constructed");
+	if (gEnabled.load() && !gPostRoutine) {
+		gPostRoutine = true;
+		qAddPostRoutine(writeAtExit);
+	}
+}
+Q_COREAPP_STARTUP_FUNCTION(applicationStarted)
+
+void StartupTrace::enable(const QString& file) {
+	gFile = file;
+	gEnabled.store(true);
+	if (QCoreApplication::instance() != nullptr && !gPostRoutine) {
+		gPostRoutine = true;
+		qAddPostRoutine(writeAtExit);
+	}
+}
+
+bool StartupTrace::isEnabled(void) {
+	return gEnabled.load(std::memory_order_relaxed);
+}
+
+bool StartupTrace::isRecording(void) {
+	return isEnabled() && gRecording.load(std::memory_order_relaxed);
+}
+
+qint64 StartupTrace::now(void) {
+	auto elapsed = std::chrono::steady_clock::now() - gOrigin;
+	return gProcessAge + qint64(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void StartupTrace::mark(const char* name) {
+	record(name, 'i', now(), 0);
+}
+
+void StartupTrace::complete(const char* name, qint64 start, qint64 duration) {
+	record(name, 'X', start, duration);
+}
+
+void StartupTrace::firstPaintDone(void) {
+	if (!isRecording())
+		return;
+	mark("first frame");
+	gRecording.store(false);
+}
+
+QJsonObject StartupTrace::toJson(void) {
+	const double pid = double(QCoreApplication::applicationPid());
+	quint64 end = gNext.load();
+	quint64 begin = end > quint64(Capacity) ? end - Capacity : 0;
+
+	QJsonArray events;
+	for (quint64 i = begin; i < end; i++) {
+		const TraceEvent& event = gEvents[i % Capacity];
+		QJsonObject json;
+		json["name"] = QString::fromLatin1(event.name);
+		json["ph"] = QString(QChar(event.phase));
+		json["ts"] = event.start / 1000.0;
+		json["pid"] = pid;
+		json["tid"] = event.thread;
+		if (event.phase == 'X')
+			json["dur"] = event.duration / 1000.0;
+		else
+			json["s"] = "p";
+		events.append(json);
+	}
+
+	QJsonObject ret;
+	ret["traceEvents"] = events;
+	ret["displayTimeUnit"] = "ms";
+	ret["droppedEvents"] = double(begin);
+	return ret;
+}
+
+bool StartupTrace::write(const QString& file) {
+	QSaveFile out(file);
+	if (!out.open(QIODevice::WriteOnly))
+		return false;
+	out.write(QJsonDocument(toJson()).toJson(QJsonDocument::Compact));
+	return out.commit();
+}
+
+StartupTrace::Scope::Scope(const char* name) : mName(name), mStart(isRecording() ? now() : -1) {
+}
+
+StartupTrace::Scope::~Scope() {
+	if (mStart >= 0)
+		complete(mName, mStart, now() - mStart);
+}
+
+}
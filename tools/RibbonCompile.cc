@@ -0,0 +1,48 @@
+// RibbonCompile: compiles a JSON ribbon description to the binary format loaded by RibbonDefinition.
+//
+// Usage: RibbonCompile source.json output.ribbon
+
+#include <RibbonDefinition.hh>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() != 3) {
+        fprintf(stderr, "usage: %s source.json output.ribbon\n", argv[0]);
+        return 2;
+    }
+
+    QFile input(args[1]);
+    if (!input.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "%s: %s\n", qPrintable(args[1]), qPrintable(input.errorString()));
+        return 1;
+    }
+    QJsonParseError parseError;
+    QJsonDocument source = QJsonDocument::fromJson(input.readAll(), &parseError);
+    if (source.isNull()) {
+        fprintf(stderr, "%s:%d: %s\n", qPrintable(args[1]), parseError.offset, qPrintable(parseError.errorString()));
+        return 1;
+    }
+
+    QString error;
+    QByteArray compiled = RibbonUI::RibbonDefinition::compile(source, &error);
+    if (compiled.isEmpty()) {
+        fprintf(stderr, "%s: %s\n", qPrintable(args[1]), qPrintable(error));
+        return 1;
+    }
+
+    QSaveFile output(args[2]);
+    if (!output.open(QIODevice::WriteOnly) || output.write(compiled) != compiled.size() || !output.commit()) {
+        fprintf(stderr, "%s: %s\n", qPrintable(args[2]), qPrintable(output.errorString()));
+        return 1;
+    }
+    return 0;
+}